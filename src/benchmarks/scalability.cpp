@@ -0,0 +1,358 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: scalability suite - throughput and efficiency over problem size and thread count
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+// Usage (every option is optional):
+//   NatureInspiredAlgosScalability --dimensions 2,8,32,128,512 --cities 1000,10000,100000,1000000
+//                                  --threads 1,2,4,8 --evaluations 20000 --quadratic-limit 10000
+//                                  --two-opt-limit 2000 --csv scalability.csv
+//
+// Every configuration runs threads x 4 independent repetitions on the BenchmarkRunner workers, so
+// the amount of work per thread is constant: with perfect scaling the throughput grows linearly with
+// the threads and the efficiency stays at 1. The efficiency is relative to the first thread count.
+//
+// The wall time of a configuration spans its runs, from the first start to the last end; the workers
+// still start one after the other (tens of microseconds each), so the throughput of configurations whose
+// runs take well under a millisecond is bound by that overhead rather than by the algorithm.
+// The memory column is the peak resident memory of a configuration over the resident memory before it;
+// where the peak cannot be reset (Windows) it is the growth of the resident memory instead.
+
+#include <tchar.h>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../stochastic/RandomSearch.h"
+#include "../stochastic/AdaptiveRandomSearch.h"
+#include "../random_generators/vectorGenerator.h"
+#include "../statistics/benchmarkRunner.h"
+#include "../problems/tsp/generators.h"
+#include "../problems/tsp/nearestNeighbour.h"
+#include "../problems/tsp/twoOpt.h"
+#include "../utility/Memory.h"
+
+namespace
+{
+  //! the repetitions every worker runs
+  constexpr size_t REPETITIONS_PER_THREAD = 4;
+
+  //! the seed of the generated instances
+  constexpr uint64_t INSTANCE_SEED = 0x5ca1ab1e;
+
+  struct SuiteOptions
+  {
+    std::vector<size_t> dimensions = { 2, 8, 32, 128, 512 };/*!< the continuous problem sizes */
+    std::vector<size_t> cities = { 1000, 10000, 100000, 1000000 };/*!< the TSP problem sizes */
+    std::vector<size_t> threads;/*!< the thread counts; 1, 2, 4, ... up to the physical cores when empty */
+    size_t evaluations = 20000;/*!< the objective evaluations of a continuous run */
+    size_t quadraticLimit = 10000;/*!< the largest instance for the O(n^2) nearest neighbour */
+    size_t twoOptLimit = 2000;/*!< the largest instance for 2-opt */
+    std::string csv;/*!< the CSV output; none when empty */
+  };
+
+  struct Measurement
+  {
+    std::string workload;/*!< the algorithm */
+    std::string instance;/*!< the instance family */
+    size_t size = 0;/*!< the dimensions or the cities */
+    size_t threads = 0;/*!< the workers */
+    size_t repetitions = 0;/*!< the independent runs */
+    double wallMillis = 0;/*!< the duration of all the runs */
+    double medianMillis = 0;/*!< the median duration of a run */
+    double throughput = 0;/*!< work units per second, see unit */
+    const char* unit = "";/*!< the work unit */
+    double efficiency = 0;/*!< throughput / (threads x single thread throughput) */
+    double averageResult = 0;/*!< the average result of the runs */
+    size_t dataBytes = 0;/*!< the problem data touched by all the workers */
+    size_t residentBytes = 0;/*!< the resident memory the configuration added (see the top of the file) */
+  };
+
+  std::vector<size_t> parseList(const std::string& text)
+  {
+    std::vector<size_t> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ','))
+    {
+      if (!item.empty())
+      {
+        values.push_back(std::stoull(item));
+      }
+    }
+
+    return values;
+  }
+
+  SuiteOptions parseOptions(int argc, TCHAR** argv)
+  {
+    SuiteOptions options;
+    for (int arg = 1; arg + 1 < argc; arg += 2)
+    {
+      const std::string option = argv[arg];
+      const std::string value = argv[arg + 1];
+      if (option == "--dimensions") options.dimensions = parseList(value);
+      else if (option == "--cities") options.cities = parseList(value);
+      else if (option == "--threads") options.threads = parseList(value);
+      else if (option == "--evaluations") options.evaluations = std::stoull(value);
+      else if (option == "--quadratic-limit") options.quadraticLimit = std::stoull(value);
+      else if (option == "--two-opt-limit") options.twoOptLimit = std::stoull(value);
+      else if (option == "--csv") options.csv = value;
+      else std::cerr << "unknown option " << option << std::endl;
+    }
+
+    if (options.threads.empty())
+    {
+      const auto cores = utility::physicalCoreProcessors().size();
+      for (size_t t = 1; t < cores; t *= 2)
+      {
+        options.threads.push_back(t);
+      }
+      options.threads.push_back(cores);
+    }
+
+    return options;
+  }
+
+  /*!
+    * \brief Runs threads x REPETITIONS_PER_THREAD repetitions of the algorithm on threads pinned workers
+    * \tparam Function - double()
+    *
+    * \param measurement[in,out] - the configuration in, the timings out
+    * \param workPerRun - the work units done by one run
+    * \param algorithm - the algorithm
+    */
+  template <class Function>
+  void measure(Measurement& measurement, double workPerRun, Function algorithm)
+  {
+    // the scaling is the point, not the confidence intervals: no warmup runs, no bootstrap
+    statistics::BenchmarkOptions options;
+    options.warmup = 0;
+    options.bootstrapResamples = 0;
+
+    statistics::RunnerOptions runnerOptions;
+    runnerOptions.mode = statistics::ExecutionMode::PARALLEL;
+    runnerOptions.threads = measurement.threads;
+    runnerOptions.seed = INSTANCE_SEED;
+    const statistics::BenchmarkRunner runner(runnerOptions);
+
+    // the wall time leaves out the creation and the joining of the workers
+    using Clock = std::chrono::steady_clock;
+    std::atomic<Clock::rep> firstStart(std::numeric_limits<Clock::rep>::max());
+    std::atomic<Clock::rep> lastEnd(std::numeric_limits<Clock::rep>::min());
+    const auto timed = [&firstStart, &lastEnd, algorithm]()
+    {
+      const auto start = Clock::now().time_since_epoch().count();
+      const auto result = algorithm();
+      const auto end = Clock::now().time_since_epoch().count();
+      for (auto seen = firstStart.load(); start < seen && !firstStart.compare_exchange_weak(seen, start);)
+      {
+        ;
+      }
+      for (auto seen = lastEnd.load(); end > seen && !lastEnd.compare_exchange_weak(seen, end);)
+      {
+        ;
+      }
+      return result;
+    };
+
+    const auto peakReset = utility::resetPeakResidentMemory();
+    const auto residentBefore = utility::residentMemoryBytes();
+
+    measurement.repetitions = measurement.threads * REPETITIONS_PER_THREAD;
+    const auto stats = runner.run(options, measurement.repetitions, measurement.workload.c_str(), false, timed);
+    measurement.wallMillis = std::chrono::duration<double, std::milli>(Clock::duration(lastEnd.load() - firstStart.load())).count();
+
+    measurement.medianMillis = stats.medianTime();
+    measurement.averageResult = stats.averageResult();
+    measurement.throughput = measurement.wallMillis > 0 ? workPerRun * measurement.repetitions * 1000.0 / measurement.wallMillis : 0;
+    const auto residentAfter = peakReset ? utility::peakResidentMemoryBytes() : utility::residentMemoryBytes();
+    measurement.residentBytes = residentAfter > residentBefore ? residentAfter - residentBefore : 0;
+  }
+
+  /*!
+    * \brief Runs the workload for every thread count and fills in the efficiencies
+    * \tparam Function - double()
+    */
+  template <class Function>
+  void scale(const SuiteOptions& options, Measurement configuration, double workPerRun, Function algorithm, std::vector<Measurement>& measurements)
+  {
+    double reference = 0;
+    size_t referenceThreads = 0;
+    for (auto threads : options.threads)
+    {
+      auto measurement = configuration;
+      measurement.threads = threads;
+      measure(measurement, workPerRun, algorithm);
+
+      if (!referenceThreads)
+      {
+        reference = measurement.throughput;
+        referenceThreads = threads;
+      }
+      measurement.efficiency = reference > 0 ? measurement.throughput * referenceThreads / (threads * reference) : 0;
+
+      std::cout << std::left << std::setw(22) << measurement.workload << std::setw(11) << measurement.instance
+                << std::right << std::setw(9) << measurement.size << std::setw(5) << measurement.threads
+                << std::setw(12) << std::fixed << std::setprecision(3) << measurement.medianMillis
+                << std::setw(14) << std::scientific << std::setprecision(3) << measurement.throughput << " " << std::left << std::setw(7) << measurement.unit
+                << std::right << std::setw(8) << std::fixed << std::setprecision(2) << measurement.efficiency
+                << std::setw(12) << measurement.dataBytes / 1024 << std::setw(12) << measurement.residentBytes / 1024 << std::endl;
+
+      measurements.push_back(measurement);
+    }
+  }
+
+  void continuousWorkloads(const SuiteOptions& options, std::vector<Measurement>& measurements)
+  {
+    const auto sphere = [](const auto& x)
+    {
+      auto sum = 0.0;
+      for (auto xi : x)
+      {
+        sum += xi * xi;
+      }
+
+      return sum;
+    };
+    const auto lower = [](double optimal, double cost) { return cost < optimal; };
+    const stochastic::SearchSpace2D<double> searchSpace(-5, 5);
+
+    for (auto dimensions : options.dimensions)
+    {
+      Measurement configuration;
+      configuration.instance = "sphere";
+      configuration.size = dimensions;
+      configuration.unit = "eval/s";
+
+      // one position per worker for the random search, the position and two trials for the adaptive one
+      configuration.workload = "randomSearch";
+      configuration.dataBytes = dimensions * sizeof(double);
+      scale(options, configuration, static_cast<double>(options.evaluations), [&, dimensions]()
+        {
+          return stochastic::randomSearch(std::numeric_limits<double>::max(), dimensions, options.evaluations, searchSpace, sphere,
+                                          stochastic::randomFill2D<double, stochastic::SearchSpace2D>, lower);
+        }, measurements);
+
+      // every iteration evaluates a step and a big step
+      configuration.workload = "adaptiveRandomSearch";
+      configuration.dataBytes = 3 * dimensions * sizeof(double);
+      scale(options, configuration, static_cast<double>(options.evaluations), [&, dimensions]()
+        {
+          return stochastic::adaptiveRandomSearch(options.evaluations / 2, dimensions, searchSpace, sphere,
+                                                  stochastic::randomGeneration2D<double, stochastic::SearchSpace2D>, lower,
+                                                  0.05, 1.3, 3.0, size_t(10), size_t(30));
+        }, measurements);
+    }
+  }
+
+  void tspWorkloads(const SuiteOptions& options, std::vector<Measurement>& measurements)
+  {
+    for (auto count : options.cities)
+    {
+      for (auto clustered : { false, true })
+      {
+        const auto cities = clustered ? problems::tsp::clusteredCities(count, std::max<size_t>(count / 1000, 4), 1000000.0, 0.02, INSTANCE_SEED)
+                                      : problems::tsp::uniformCities(count, 1000000.0, INSTANCE_SEED);
+        const auto citiesBytes = count * sizeof(problems::tsp::City);
+
+        Measurement configuration;
+        configuration.instance = clustered ? "clustered" : "uniform";
+        configuration.size = count;
+
+        // a shuffled tour: the evaluation jumps all over the cities, like it does for a real tour early on
+        problems::tsp::TourArray shuffled(count);
+        std::iota(shuffled.begin(), shuffled.end(), size_t(0));
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(INSTANCE_SEED));
+
+        configuration.workload = "tourLength";
+        configuration.unit = "edge/s";
+        configuration.dataBytes = citiesBytes + count * sizeof(size_t);
+        scale(options, configuration, static_cast<double>(count), [&]()
+          {
+            return problems::tsp::tourLength(cities, shuffled);
+          }, measurements);
+
+        if (count > options.quadraticLimit)
+        {
+          std::cout << "nearestNeighbour/" << configuration.instance << " " << count << ": skipped, above the quadratic limit (" << options.quadraticLimit << ")" << std::endl;
+          continue;
+        }
+
+        // a random start per repetition, drawn from the worker's (reseeded) engine
+        configuration.workload = "nearestNeighbour";
+        configuration.unit = "dist/s";
+        configuration.dataBytes = citiesBytes + count * (sizeof(size_t) + 1);
+        scale(options, configuration, static_cast<double>(count) * (count - 1) / 2, [&]()
+          {
+            problems::tsp::TourArray tour;
+            double length = 0;
+            const auto start = std::uniform_int_distribution<size_t>(0, count - 1)(randomGenerators::DefaultRandomEngine::get());
+            problems::tsp::nearestNeighbour(cities, start, tour, length);
+            return length;
+          }, measurements);
+
+        if (count > options.twoOptLimit)
+        {
+          std::cout << "twoOpt/" << configuration.instance << " " << count << ": skipped, above the 2-opt limit (" << options.twoOptLimit << ")" << std::endl;
+          continue;
+        }
+
+        configuration.workload = "nearestNeighbour+2opt";
+        configuration.unit = "tour/s";
+        scale(options, configuration, 1.0, [&]()
+          {
+            problems::tsp::TourArray tour;
+            double length = 0;
+            const auto start = std::uniform_int_distribution<size_t>(0, count - 1)(randomGenerators::DefaultRandomEngine::get());
+            problems::tsp::nearestNeighbour(cities, start, tour, length);
+            problems::tsp::twoOptMove(cities, tour);
+            return problems::tsp::tourLength(cities, tour);
+          }, measurements);
+      }
+    }
+  }
+
+  void writeCsv(std::ostream& out, const std::vector<Measurement>& measurements)
+  {
+    out << "workload,instance,size,threads,repetitions,wall_ms,median_ms,throughput,unit,efficiency,average_result,data_bytes,resident_bytes\n";
+    out << std::setprecision(17);
+    for (auto& m : measurements)
+    {
+      out << m.workload << "," << m.instance << "," << m.size << "," << m.threads << "," << m.repetitions << ","
+          << m.wallMillis << "," << m.medianMillis << "," << m.throughput << "," << m.unit << "," << m.efficiency << ","
+          << m.averageResult << "," << m.dataBytes << "," << m.residentBytes << "\n";
+    }
+  }
+}
+
+int main(int argc, TCHAR** argv)
+{
+  const auto options = parseOptions(argc, argv);
+
+  std::cout << std::left << std::setw(22) << "workload" << std::setw(11) << "instance"
+            << std::right << std::setw(9) << "size" << std::setw(5) << "thr"
+            << std::setw(12) << "median ms" << std::setw(22) << "throughput"
+            << std::setw(8) << "eff" << std::setw(12) << "data KiB" << std::setw(12) << "+RSS KiB" << std::endl;
+
+  std::vector<Measurement> measurements;
+  continuousWorkloads(options, measurements);
+  tspWorkloads(options, measurements);
+
+  if (!options.csv.empty())
+  {
+    std::ofstream csv(options.csv);
+    writeCsv(csv, measurements);
+  }
+
+  return 0;
+}
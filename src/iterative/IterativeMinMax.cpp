@@ -6,16 +6,13 @@
 
 double iterative::unitTest::iterativeMin()
 {
+  // the sphere function is a sum of squares, so let the sweep update it term by term
   return iterative::optima(std::numeric_limits<double>::max(), BENCHMARK_PROBLEM_SIZE, stochastic::SearchSpace2D<double>(-5.0, 5.0),
-    [](const std::vector<double>& xi) {
-      auto sum = 0.0;
-      for (int i = 0; i < xi.size(); ++i)
-      {
-        sum += (xi[i] * xi[i]);
+    iterative::makeSeparableObjective<double>(
+      [](size_t, double xi) {
+        return xi * xi;
       }
-
-      return sum;
-    },
+    ),
     [](double oldOptimal, double valueToCheck) {
       return valueToCheck < oldOptimal;
     }
@@ -8,109 +8,360 @@
 #define __ITERATIVE_MIN_MAX_H__
 
 #include <xmemory>
-#include <functional>
+#include <vector>
+#include <cmath>
 
 #include "../utility/Defines.h"
+#include "../utility/ThreadPool.h"
+#include "../utility/Concepts.h"
+#include "../utility/FixedDimension.h"
+
+#include "SeparableObjective.h"
+#include "SimdMinMax.h"
 
 /*! \defgroup iterative Non-smart iterative methods - for benchmarks */
 namespace iterative
 {
   /*!
-  * \brief Iterative algorithm to look for the smallest element of a std::vector
-  * \tparam Type - the type of the elements inside the vector
-  * \tparam Container - the vector type
+  * \brief Iterative algorithm to look for the smallest element of a contiguous container (vectorized, see SimdMinMax.h)
+  * \tparam Container - any contiguous range (std::vector with any allocator, std::array, ...)
   *
-  * \param container - the vector for which we require the minimum
+  * \param container - the container for which we require the minimum; must not be empty
   *
-  * \return the smallest element inside the vector
+  * \return the smallest element inside the container
   * \ingroup iterative
   */
-  template <class Type, template <class, class> class Container>
-  Type min(const Container<Type, std::allocator<Type>>& container)
+  template <std::ranges::contiguous_range Container>
+  auto min(const Container& container)
   {
-    auto min = container[0];
-    for (auto& element : container)
-    {
-      min = element < min ? element : min;
-    }
-
-    return min;
+    return iterative::min(std::span<const std::ranges::range_value_t<Container>>(utility::asSpan(container)));
   }
 
   /*!
-  * \brief Iterative algorithm to look for the largest element of a std::vector
-  * \tparam Type - the type of the elements inside the vector
-  * \tparam Container - the vector type
+  * \brief Iterative algorithm to look for the largest element of a contiguous container (vectorized, see SimdMinMax.h)
+  * \tparam Container - any contiguous range (std::vector with any allocator, std::array, ...)
   *
-  * \param container - the vector for which we require the maximum
+  * \param container - the container for which we require the maximum; must not be empty
   *
-  * \return the largest element inside the vector
+  * \return the largest element inside the container
   * \ingroup iterative
   */
-  template <class Type, template <class, class> class Container>
-  Type max(const Container<Type, std::allocator<Type>>& container)
+  template <std::ranges::contiguous_range Container>
+  auto max(const Container& container)
+  {
+    return iterative::max(std::span<const std::ranges::range_value_t<Container>>(utility::asSpan(container)));
+  }
+
+
+  /*! \class MixedRadixGrid "IterativeMinMax.h"
+    * \brief A regular grid over the search space, addressed by a single flat index.
+    *
+    * Dimension d holds radix(d) points: left, left + step[d], ..., up to right.
+    * The flat index is a mixed-radix number whose last digit is the innermost dimension,
+    * so consecutive indices only move the last coordinate (except on carries).
+    * \tparam Type - the coordinate type
+    * \ingroup iterative
+    */
+  template <typename Type>
+  class MixedRadixGrid
   {
-    auto max = container[0];
-    for (auto& element : container)
+  public:
+
+    /*!
+      * \brief init c-tor
+      * \param left - the smallest coordinate on every axis
+      * \param right - the largest coordinate on every axis
+      * \param steps - the grid step for every dimension
+      */
+    MixedRadixGrid(Type left, Type right, std::span<const Type> steps) :
+      _left(left)
+    , _steps(steps.begin(), steps.end())
+    , _radix(steps.size())
+    , _size(steps.empty() ? 0 : 1)
     {
-      max = element > max ? element : max;
+      const auto length = right - left;
+      for (size_t d = 0; d < steps.size(); ++d)
+      {
+        // the tolerance keeps the right end on the grid when length / step is "almost" whole
+        _radix[d] = static_cast<size_t>(std::floor(length / steps[d] + 1e-9)) + 1;
+        _size *= _radix[d];
+      }
     }
 
-    return max;
-  }
+    //! the number of dimensions
+    size_t dimensions() const { return _radix.size(); }
+
+    //! the number of points on the given axis
+    size_t radix(size_t dimension) const { return _radix[dimension]; }
+
+    //! the total number of grid points
+    size_t size() const { return _size; }
+
+    //! the coordinate of the given digit on the given axis
+    Type coordinate(size_t dimension, size_t digit) const
+    {
+      // computed from the origin rather than accumulated, so no drift over long axes
+      return _left + static_cast<Type>(digit) * _steps[dimension];
+    }
+
+    /*!
+      * \brief Decodes a flat index into per dimension digits and the matching point.
+      *
+      * The digits and the point are any contiguous containers of dimensions() elements; with std::array
+      * the loop has a compile time trip count and unrolls.
+      * \param[in] index - the flat index
+      * \param[out] digits - the mixed-radix digits
+      * \param[out] point - the grid point
+      */
+    template <class Digits, class Point>
+    void decode(size_t index, Digits& digits, Point& point) const
+    {
+      for (auto d = std::size(digits); d-- > 0;)
+      {
+        digits[d] = index % _radix[d];
+        index /= _radix[d];
+        point[d] = coordinate(d, digits[d]);
+      }
+    }
+
+    /*!
+      * \brief Moves to the next grid point (odometer style, last dimension first).
+      * \param[in,out] digits - the mixed-radix digits
+      * \param[in,out] point - the grid point
+      *
+      * \return the lowest dimension that changed
+      */
+    template <class Digits, class Point>
+    size_t next(Digits& digits, Point& point) const
+    {
+      auto d = std::size(digits);
+      while (d-- > 0)
+      {
+        if (++digits[d] < _radix[d])
+        {
+          point[d] = coordinate(d, digits[d]);
+          return d;
+        }
+        digits[d] = 0;
+        point[d] = coordinate(d, 0);
+      }
+
+      return 0;
+    }
+
+    /*!
+      * \brief Decodes a flat index into per dimension digits.
+      * \param[in] index - the flat index
+      * \param[out] digits - the mixed-radix digits
+      */
+    template <class Digits>
+    void decode(size_t index, Digits& digits) const
+    {
+      for (auto d = std::size(digits); d-- > 0;)
+      {
+        digits[d] = index % _radix[d];
+        index /= _radix[d];
+      }
+    }
+
+    /*!
+      * \brief Moves the digits to the next grid point (odometer style, last dimension first).
+      * \param[in,out] digits - the mixed-radix digits
+      *
+      * \return the lowest dimension that changed
+      */
+    template <class Digits>
+    size_t next(Digits& digits) const
+    {
+      auto d = std::size(digits);
+      while (d-- > 0)
+      {
+        if (++digits[d] < _radix[d])
+        {
+          return d;
+        }
+        digits[d] = 0;
+      }
+
+      return 0;
+    }
+
+  protected:
+    Type _left;
+    std::vector<Type> _steps;
+    std::vector<size_t> _radix;
+    size_t _size;
+  };
 
 
   /*!
-    * \brief Iteratively computes the optima for the given objective function    
+    * \brief Exhaustively computes the optima for the given objective function over a regular grid
+    *
+    * The grid is walked through a flat (mixed-radix) index. The index range is split in
+    * contiguous chunks, a few per thread, run on the shared utility::ThreadPool; each chunk keeps
+    * its own optima and the per chunk optima are reduced at the end using costEvalFunction.
+    *
+    * If the objective is separable (see IsSeparable) every per dimension term is evaluated once
+    * per grid coordinate and the sweep only updates the partial sums of the dimensions that
+    * changed, so a grid point costs O(1) instead of a full O(problem size) evaluation.
+    *
+    * Up to utility::MAX_FIXED_DIMENSION dimensions the digits, the partial sums and the point are
+    * std::array (selected at compile time, see utility::dispatchDimension) and the odometer loops unroll;
+    * a non separable objective then receives a std::array<Type, dimensions> if it accepts one (a generic
+    * lambda or a std::span<const Type>), otherwise the sweep falls back to std::vector.
     * \tparam Type - the data type used by the algorithm
+    * \tparam Steps - any contiguous range of Type
     * \tparam SearchSpace - the search space type
     * \tparam ObjectiveFunction - the objective function type
     * \tparam CostEvalFunction - the cost function type
     *
     * \param initialOptima - initial value for the optima
-    * \param problemSize - size of the parameters vector
+    * \param steps - the grid step for each dimension; its size is the problem size
     * \param searchSpace - the search space
-    * \param objectiveFunction - the function we want to optimize
+    * \param objectiveFunction - the function we want to optimize; must be callable concurrently
     * \param costEvalFunction - the function we use to evaluate the cost
+    * \param threads - the number of threads to use
     *
     * \return the optima
     * \ingroup iterative
     */
-  template <typename Type, template <class> class SearchSpace, class ObjectiveFunction, class CostEvalFunction>
-  Type optima(Type initialOptima, size_t problemSize, SearchSpace<Type> searchSpace, ObjectiveFunction objectiveFunction, CostEvalFunction costEvalFunction)
+  template <typename Type, class Steps, template <class> class SearchSpace, class ObjectiveFunction, class CostEvalFunction>
+    requires utility::ContiguousRangeOf<Steps, Type>
+  Type optima(Type initialOptima, const Steps& steps, SearchSpace<Type> searchSpace, ObjectiveFunction objectiveFunction, CostEvalFunction costEvalFunction,
+              size_t threads = utility::hardwareThreads())
   {
-    std::vector<Type> parameters(problemSize);
-    auto result = initialOptima;
-    
-    std::function<void(int)> loop = [&](int index)
+    const MixedRadixGrid<Type> grid(searchSpace.left(), searchSpace.right(), utility::asSpan(steps));
+
+    // a few chunks per thread balance the load; a chunk restarts the sweep, so not too small either
+    threads = std::max<size_t>(threads, 1);
+    const auto grain = std::max<size_t>(grid.size() / (8 * threads), 1 << 12);
+    std::vector<Type> results((grid.size() + grain - 1) / grain, initialOptima);
+
+    constexpr auto separable = IsSeparable<ObjectiveFunction, Type>::value;
+
+    // terms[d][k] - the contribution of dimension d at its k-th grid coordinate
+    std::vector<std::vector<Type>> terms;
+    if constexpr (separable)
+    {
+      terms.resize(grid.dimensions());
+      FOR(d, grid.dimensions())
+      {
+        terms[d].resize(grid.radix(d));
+        FOR(k, grid.radix(d))
+        {
+          terms[d][k] = objectiveFunction.term(d, grid.coordinate(d, k));
+        }
+      }
+    }
+
+    // sweeps [begin, end); Extent is the compile time number of dimensions, or std::dynamic_extent
+    const auto sweep = [&](auto extent, size_t begin, size_t end)
     {
-      if (index == parameters.size() - 1)
+      constexpr auto Extent = decltype(extent)::value;
+      auto result = initialOptima;
+      auto digits = utility::makeDimensionArray<size_t, Extent>(grid.dimensions());
+
+      if constexpr (separable)
       {
-        for (auto i = searchSpace.left(); i <= searchSpace.right(); i += 0.01)
+        // prefix[d] - the cost contributed by the dimensions [0, d)
+        const auto last = std::size(digits) - 1;
+        auto prefix = utility::makeDimensionArray<Type, Extent>(grid.dimensions(), static_cast<Type>(0));
+        grid.decode(begin, digits);
+        for (size_t d = 0; d < last; ++d)
         {
-          parameters[index] = i;
-          auto instResult = objectiveFunction(parameters);
+          prefix[d + 1] = prefix[d] + terms[d][digits[d]];
+        }
+
+        const auto& innermost = terms[last];
+        for (auto index = begin; index < end; ++index)
+        {
+          const auto instResult = prefix[last] + innermost[digits[last]];
           if (costEvalFunction(result, instResult))
           {
             result = instResult;
           }
+
+          // only the partial sums after the lowest changed dimension need refreshing
+          for (auto d = grid.next(digits); d < last; ++d)
+          {
+            prefix[d + 1] = prefix[d] + terms[d][digits[d]];
+          }
         }
       }
       else
       {
-        for (auto i = searchSpace.left(); i <= searchSpace.right(); i += 0.01)
+        auto parameters = utility::makeDimensionArray<Type, Extent>(grid.dimensions());
+        grid.decode(begin, digits, parameters);
+
+        for (auto index = begin; index < end; ++index)
         {
-          parameters[index] = i;
-          loop(index + 1);
+          const auto instResult = objectiveFunction(parameters);
+          if (costEvalFunction(result, instResult))
+          {
+            result = instResult;
+          }
+          grid.next(digits, parameters);
         }
       }
+
+      return result;
     };
 
-    loop(0);
+    const auto used = utility::ThreadPool::shared().parallelFor(grid.size(), grain,
+      [&](size_t chunk, size_t begin, size_t end)
+      {
+        results[chunk] = utility::dispatchDimension(grid.dimensions(),
+          [&](auto extent)
+          {
+            if constexpr (separable || std::invocable<ObjectiveFunction&, std::array<Type, decltype(extent)::value>&>)
+            {
+              return sweep(extent, begin, end);
+            }
+            else
+            {
+              return sweep(utility::DynamicDimension(), begin, end);
+            }
+          },
+          [&]() { return sweep(utility::DynamicDimension(), begin, end); });
+      },
+      threads
+    );
+
+    auto result = initialOptima;
+    FOR(chunk, used)
+    {
+      if (costEvalFunction(result, results[chunk]))
+      {
+        result = results[chunk];
+      }
+    }
 
     return result;
   }
 
+
+  /*!
+    * \brief Exhaustively computes the optima for the given objective function using a 0.01 step on every axis
+    * \tparam Type - the data type used by the algorithm
+    * \tparam SearchSpace - the search space type
+    * \tparam ObjectiveFunction - the objective function type
+    * \tparam CostEvalFunction - the cost function type
+    *
+    * \param initialOptima - initial value for the optima
+    * \param problemSize - size of the parameters vector
+    * \param searchSpace - the search space
+    * \param objectiveFunction - the function we want to optimize
+    * \param costEvalFunction - the function we use to evaluate the cost
+    *
+    * \return the optima
+    * \ingroup iterative
+    */
+  template <typename Type, template <class> class SearchSpace, class ObjectiveFunction, class CostEvalFunction>
+  Type optima(Type initialOptima, size_t problemSize, SearchSpace<Type> searchSpace, ObjectiveFunction objectiveFunction, CostEvalFunction costEvalFunction)
+  {
+    return optima(initialOptima, std::vector<Type>(problemSize, static_cast<Type>(0.01)), searchSpace, objectiveFunction, costEvalFunction);
+  }
+
   namespace unitTest {
     double iterativeMin();
   }
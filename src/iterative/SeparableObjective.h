@@ -0,0 +1,108 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: objective functions that are a sum of per dimension terms
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __SEPARABLE_OBJECTIVE_H__
+#define __SEPARABLE_OBJECTIVE_H__
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace iterative
+{
+  /*! \class SeparableObjective "SeparableObjective.h"
+    * \brief An objective function of the form f(x) = term(0, x[0]) + ... + term(n - 1, x[n - 1]).
+    *
+    * It can be used as a regular objective function (it is callable with the parameters vector),
+    * and it also exposes each dimension's contribution through term(), which lets the algorithms
+    * update the cost incrementally when only some of the coordinates change.
+    * \tparam Type - the cost type
+    * \tparam TermFunction - Type(size_t dimension, Type coordinate)
+    * \ingroup iterative
+    */
+  template <typename Type, class TermFunction>
+  class SeparableObjective
+  {
+  public:
+
+    /*!
+      * \brief init c-tor
+      * \param term - the function computing the contribution of one dimension
+      */
+    explicit SeparableObjective(TermFunction term) :
+      _term(term)
+    {
+      ;
+    }
+
+    /*!
+      * \brief the contribution of one dimension to the cost
+      * \param dimension - the dimension
+      * \param coordinate - the coordinate on that dimension
+      *
+      * \return the contribution to the cost
+      */
+    Type term(size_t dimension, Type coordinate) const
+    {
+      return _term(dimension, coordinate);
+    }
+
+    /*!
+      * \brief full evaluation of the objective
+      * \tparam Parameters - an indexable container
+      * \param parameters - the position to evaluate
+      *
+      * \return the cost
+      */
+    template <class Parameters>
+    Type operator()(const Parameters& parameters) const
+    {
+      auto sum = static_cast<Type>(0);
+      for (size_t d = 0; d < parameters.size(); ++d)
+      {
+        sum += _term(d, parameters[d]);
+      }
+
+      return sum;
+    }
+
+  protected:
+    TermFunction _term;
+  };
+
+
+  /*!
+    * \brief Helper to deduce the term function type
+    * \tparam Type - the cost type
+    * \tparam TermFunction - Type(size_t dimension, Type coordinate)
+    *
+    * \param term - the function computing the contribution of one dimension
+    *
+    * \return the separable objective
+    * \ingroup iterative
+    */
+  template <typename Type, class TermFunction>
+  SeparableObjective<Type, TermFunction> makeSeparableObjective(TermFunction term)
+  {
+    return SeparableObjective<Type, TermFunction>(term);
+  }
+
+
+  /*!
+    * \brief Trait telling whether ObjectiveFunction exposes per dimension terms (see SeparableObjective).
+    *
+    * Anything with a `Type term(size_t, Type) const` member qualifies; everything else
+    * is evaluated as a black box.
+    * \ingroup iterative
+    */
+  template <class ObjectiveFunction, typename Type, class = void>
+  struct IsSeparable : std::false_type {};
+
+  template <class ObjectiveFunction, typename Type>
+  struct IsSeparable<ObjectiveFunction, Type, std::void_t<decltype(std::declval<const ObjectiveFunction&>().term(size_t(0), std::declval<Type>()))>> : std::true_type {};
+}
+
+#endif // !__SEPARABLE_OBJECTIVE_H__
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "SimdMinMax.h"
+
+namespace {
+  // the scalar reference: the first smallest (or largest) element that is not NaN; 0 when they all are
+  template <typename Type>
+  size_t referenceArg(const std::vector<Type>& values, bool smallest)
+  {
+    size_t result = values.size();
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+      if (iterative::isNaN(values[i]))
+      {
+        continue;
+      }
+      if (result == values.size() || (smallest ? values[i] < values[result] : values[i] > values[result]))
+      {
+        result = i;
+      }
+    }
+
+    return result < values.size() ? result : 0;
+  }
+
+  // the same value, or both NaN
+  template <typename Type>
+  bool same(Type a, Type b)
+  {
+    return a == b || (iterative::isNaN(a) && iterative::isNaN(b));
+  }
+
+  // the kernels against the reference on one input; returns the number of mismatches
+  template <typename Type>
+  size_t check(const std::vector<Type>& values)
+  {
+    const std::span<const Type> span(values);
+    const auto smallest = referenceArg(values, true);
+    const auto largest = referenceArg(values, false);
+    const auto [low, high] = iterative::minmax(span);
+
+    size_t mismatches = 0;
+    mismatches += iterative::argmin(span) != smallest;
+    mismatches += iterative::argmax(span) != largest;
+    mismatches += !same(iterative::min(span), values[smallest]);
+    mismatches += !same(iterative::max(span), values[largest]);
+    mismatches += !same(low, values[smallest]);
+    mismatches += !same(high, values[largest]);
+    return mismatches;
+  }
+
+  // every size up to a few registers (all the tails), few distinct values (ties), with and without NaNs
+  template <typename Type>
+  size_t checkSizes(std::mt19937& engine)
+  {
+    std::uniform_int_distribution<int> value(-3, 3);
+    size_t mismatches = 0;
+    for (size_t size = 1; size <= 70; ++size)
+    {
+      FOR(round, 20)
+      {
+        std::vector<Type> values(size);
+        for (auto& v : values)
+        {
+          v = static_cast<Type>(value(engine));
+        }
+
+        if constexpr (std::numeric_limits<Type>::has_quiet_NaN)
+        {
+          // a few NaNs anywhere (the first element included), or all of them
+          if (round % 4 == 1)
+          {
+            for (auto& v : values)
+            {
+              v = engine() % 3 ? v : std::numeric_limits<Type>::quiet_NaN();
+            }
+          }
+          else if (round % 4 == 2)
+          {
+            values[0] = std::numeric_limits<Type>::quiet_NaN();
+          }
+          else if (round == 3)
+          {
+            std::fill(values.begin(), values.end(), std::numeric_limits<Type>::quiet_NaN());
+          }
+        }
+
+        mismatches += check(values);
+      }
+    }
+
+    return mismatches;
+  }
+}
+
+double iterative::unitTest::simdMinMax()
+{
+  std::mt19937 engine(2020);
+  auto mismatches = checkSizes<double>(engine) + checkSizes<float>(engine) + checkSizes<int>(engine);
+
+  // the parallel merge: a leading chunk of NaNs, the minimum tied in two later chunks
+  std::vector<double> values(4 * PARALLEL_REDUCTION_GRAIN + 5, 1.0);
+  std::fill(values.begin(), values.begin() + PARALLEL_REDUCTION_GRAIN + 3, std::numeric_limits<double>::quiet_NaN());
+  values[2 * PARALLEL_REDUCTION_GRAIN + 7] = -1.0;
+  values[3 * PARALLEL_REDUCTION_GRAIN + 1] = -1.0;
+  values[values.size() - 1] = 2.0;
+  const std::span<const double> span(values);
+  mismatches += iterative::parallelArgmin(span, 4) != 2 * PARALLEL_REDUCTION_GRAIN + 7;
+  mismatches += iterative::parallelArgmax(span, 4) != values.size() - 1;
+  mismatches += iterative::parallelMin(span, 4) != -1.0;
+  mismatches += iterative::parallelMax(span, 4) != 2.0;
+
+  assert(mismatches == 0);
+  return static_cast<double>(mismatches);
+}
@@ -0,0 +1,565 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: vectorized min / max / argmin / argmax reductions over contiguous memory
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __SIMD_MIN_MAX_H__
+#define __SIMD_MIN_MAX_H__
+
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <bit>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+#include "../utility/Defines.h"
+#include "../utility/ThreadPool.h"
+
+namespace iterative
+{
+  /*! \class SimdTraits "SimdMinMax.h"
+    * \brief Describes the vector registers available for Type.
+    *
+    * The primary template means "no vector path": the kernels fall back to scalar loops.
+    * Specializations exist for float and double when the compiler targets AVX2 (/arch:AVX2)
+    * or AVX-512 (/arch:AVX512); the widest available instruction set is used.
+    * less() gives a lane mask, and select(mask, a, b) takes a where the mask is set and b elsewhere.
+    * min(a, b) and max(a, b) return b when either lane is NaN (the x86 semantics), which the reductions
+    * below rely on to skip NaNs.
+    * \tparam Type - the element type
+    * \ingroup iterative
+    */
+  template <typename Type>
+  struct SimdTraits
+  {
+    static constexpr bool vectorized = false;
+  };
+
+#if defined(__AVX512F__)
+  template <>
+  struct SimdTraits<double>
+  {
+    static constexpr bool vectorized = true;
+    static constexpr size_t width = 8;
+    using Register = __m512d;
+
+    static Register load(const double* data) { return _mm512_loadu_pd(data); }
+    static Register broadcast(double value) { return _mm512_set1_pd(value); }
+    static Register add(Register a, Register b) { return _mm512_add_pd(a, b); }
+    static Register min(Register a, Register b) { return _mm512_min_pd(a, b); }
+    static Register max(Register a, Register b) { return _mm512_max_pd(a, b); }
+    static double reduceMin(Register a) { return _mm512_reduce_min_pd(a); }
+    static double reduceMax(Register a) { return _mm512_reduce_max_pd(a); }
+    static unsigned equalMask(Register a, Register b) { return _mm512_cmp_pd_mask(a, b, _CMP_EQ_OQ); }
+    using Mask = __mmask8;
+    static Mask less(Register a, Register b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+    static Register select(Mask mask, Register a, Register b) { return _mm512_mask_blend_pd(mask, b, a); }
+    static void store(double* data, Register a) { _mm512_storeu_pd(data, a); }
+  };
+
+  template <>
+  struct SimdTraits<float>
+  {
+    static constexpr bool vectorized = true;
+    static constexpr size_t width = 16;
+    using Register = __m512;
+
+    static Register load(const float* data) { return _mm512_loadu_ps(data); }
+    static Register broadcast(float value) { return _mm512_set1_ps(value); }
+    static Register add(Register a, Register b) { return _mm512_add_ps(a, b); }
+    static Register min(Register a, Register b) { return _mm512_min_ps(a, b); }
+    static Register max(Register a, Register b) { return _mm512_max_ps(a, b); }
+    static float reduceMin(Register a) { return _mm512_reduce_min_ps(a); }
+    static float reduceMax(Register a) { return _mm512_reduce_max_ps(a); }
+    static unsigned equalMask(Register a, Register b) { return _mm512_cmp_ps_mask(a, b, _CMP_EQ_OQ); }
+    using Mask = __mmask16;
+    static Mask less(Register a, Register b) { return _mm512_cmp_ps_mask(a, b, _CMP_LT_OQ); }
+    static Register select(Mask mask, Register a, Register b) { return _mm512_mask_blend_ps(mask, b, a); }
+    static void store(float* data, Register a) { _mm512_storeu_ps(data, a); }
+  };
+#elif defined(__AVX2__)
+  template <>
+  struct SimdTraits<double>
+  {
+    static constexpr bool vectorized = true;
+    static constexpr size_t width = 4;
+    using Register = __m256d;
+
+    static Register load(const double* data) { return _mm256_loadu_pd(data); }
+    static Register broadcast(double value) { return _mm256_set1_pd(value); }
+    static Register add(Register a, Register b) { return _mm256_add_pd(a, b); }
+    static Register min(Register a, Register b) { return _mm256_min_pd(a, b); }
+    static Register max(Register a, Register b) { return _mm256_max_pd(a, b); }
+    static double reduceMin(Register a)
+    {
+      const auto half = _mm_min_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+      return _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+    static double reduceMax(Register a)
+    {
+      const auto half = _mm_max_pd(_mm256_castpd256_pd128(a), _mm256_extractf128_pd(a, 1));
+      return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+    static unsigned equalMask(Register a, Register b) { return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_EQ_OQ))); }
+    using Mask = Register;
+    static Mask less(Register a, Register b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+    static Register select(Mask mask, Register a, Register b) { return _mm256_blendv_pd(b, a, mask); }
+    static void store(double* data, Register a) { _mm256_storeu_pd(data, a); }
+  };
+
+  template <>
+  struct SimdTraits<float>
+  {
+    static constexpr bool vectorized = true;
+    static constexpr size_t width = 8;
+    using Register = __m256;
+
+    static Register load(const float* data) { return _mm256_loadu_ps(data); }
+    static Register broadcast(float value) { return _mm256_set1_ps(value); }
+    static Register add(Register a, Register b) { return _mm256_add_ps(a, b); }
+    static Register min(Register a, Register b) { return _mm256_min_ps(a, b); }
+    static Register max(Register a, Register b) { return _mm256_max_ps(a, b); }
+    static float reduceMin(Register a)
+    {
+      auto half = _mm_min_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+      half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+      return _mm_cvtss_f32(_mm_min_ss(half, _mm_shuffle_ps(half, half, 1)));
+    }
+    static float reduceMax(Register a)
+    {
+      auto half = _mm_max_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+      half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+      return _mm_cvtss_f32(_mm_max_ss(half, _mm_shuffle_ps(half, half, 1)));
+    }
+    static unsigned equalMask(Register a, Register b) { return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_EQ_OQ))); }
+    using Mask = Register;
+    static Mask less(Register a, Register b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+    static Register select(Mask mask, Register a, Register b) { return _mm256_blendv_ps(b, a, mask); }
+    static void store(float* data, Register a) { _mm256_storeu_ps(data, a); }
+  };
+#endif
+
+
+  //! tells whether value is NaN; never true for integers
+  template <typename Type>
+  constexpr bool isNaN(Type value)
+  {
+    return value != value;
+  }
+
+  //! the reductions' starting value: +infinity for min (-infinity for max), which every number beats
+  template <typename Type>
+  constexpr Type reductionIdentity(bool smallest)
+  {
+    return smallest ? std::numeric_limits<Type>::infinity() : -std::numeric_limits<Type>::infinity();
+  }
+
+
+  /*!
+    * \brief Vectorized search for the first element equal to value
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements
+    * \param value - the value to look for
+    *
+    * \return the index of the first match or values.size() if there is none
+    * \ingroup iterative
+    */
+  template <typename Type>
+  size_t findFirst(std::span<const Type> values, Type value)
+  {
+    const auto data = values.data();
+    const auto size = values.size();
+    size_t i = 0;
+
+    if constexpr (SimdTraits<Type>::vectorized)
+    {
+      using Simd = SimdTraits<Type>;
+      const auto needle = Simd::broadcast(value);
+      for (; i + Simd::width <= size; i += Simd::width)
+      {
+        if (const auto mask = Simd::equalMask(Simd::load(data + i), needle))
+        {
+          return i + std::countr_zero(mask);
+        }
+      }
+    }
+
+    for (; i < size; ++i)
+    {
+      if (data[i] == value)
+      {
+        return i;
+      }
+    }
+
+    return size;
+  }
+
+
+  /*!
+    * \brief Vectorized search for the smallest element
+    *
+    * NaNs are ignored: the result is the smallest of the other elements, NaN only when every element is NaN.
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    *
+    * \return the smallest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  Type min(std::span<const Type> values)
+  {
+    const auto data = values.data();
+    const auto size = values.size();
+    auto result = data[0];
+    size_t i = 0;
+
+    if constexpr (SimdTraits<Type>::vectorized)
+    {
+      using Simd = SimdTraits<Type>;
+      if (size >= Simd::width)
+      {
+        // two accumulators hide the latency of the min instruction; the loaded values come first,
+        // so a NaN among them leaves the accumulator as it was
+        auto acc0 = Simd::broadcast(reductionIdentity<Type>(true));
+        auto acc1 = acc0;
+        for (i = 0; i + 2 * Simd::width <= size; i += 2 * Simd::width)
+        {
+          acc0 = Simd::min(Simd::load(data + i), acc0);
+          acc1 = Simd::min(Simd::load(data + i + Simd::width), acc1);
+        }
+        for (; i + Simd::width <= size; i += Simd::width)
+        {
+          acc0 = Simd::min(Simd::load(data + i), acc0);
+        }
+        result = Simd::reduceMin(Simd::min(acc0, acc1));
+      }
+    }
+
+    for (; i < size; ++i)
+    {
+      result = data[i] < result || isNaN(result) ? data[i] : result;
+    }
+
+    if constexpr (SimdTraits<Type>::vectorized)
+    {
+      // nothing beat the starting value: every element is NaN, unless some are infinite
+      if (result == reductionIdentity<Type>(true) && findFirst(values, result) == size)
+      {
+        return std::numeric_limits<Type>::quiet_NaN();
+      }
+    }
+
+    return result;
+  }
+
+
+  /*!
+    * \brief Vectorized search for the largest element
+    *
+    * NaNs are ignored, as in min().
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    *
+    * \return the largest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  Type max(std::span<const Type> values)
+  {
+    const auto data = values.data();
+    const auto size = values.size();
+    auto result = data[0];
+    size_t i = 0;
+
+    if constexpr (SimdTraits<Type>::vectorized)
+    {
+      using Simd = SimdTraits<Type>;
+      if (size >= Simd::width)
+      {
+        auto acc0 = Simd::broadcast(reductionIdentity<Type>(false));
+        auto acc1 = acc0;
+        for (i = 0; i + 2 * Simd::width <= size; i += 2 * Simd::width)
+        {
+          acc0 = Simd::max(Simd::load(data + i), acc0);
+          acc1 = Simd::max(Simd::load(data + i + Simd::width), acc1);
+        }
+        for (; i + Simd::width <= size; i += Simd::width)
+        {
+          acc0 = Simd::max(Simd::load(data + i), acc0);
+        }
+        result = Simd::reduceMax(Simd::max(acc0, acc1));
+      }
+    }
+
+    for (; i < size; ++i)
+    {
+      result = data[i] > result || isNaN(result) ? data[i] : result;
+    }
+
+    if constexpr (SimdTraits<Type>::vectorized)
+    {
+      if (result == reductionIdentity<Type>(false) && findFirst(values, result) == size)
+      {
+        return std::numeric_limits<Type>::quiet_NaN();
+      }
+    }
+
+    return result;
+  }
+
+
+  /*!
+    * \brief Vectorized search for both the smallest and the largest element, in a single pass
+    *
+    * NaNs are ignored, as in min().
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    *
+    * \return (smallest, largest)
+    * \ingroup iterative
+    */
+  template <typename Type>
+  std::pair<Type, Type> minmax(std::span<const Type> values)
+  {
+    const auto data = values.data();
+    const auto size = values.size();
+    auto smallest = data[0];
+    auto largest = data[0];
+    size_t i = 0;
+
+    if constexpr (SimdTraits<Type>::vectorized)
+    {
+      using Simd = SimdTraits<Type>;
+      if (size >= Simd::width)
+      {
+        auto accMin = Simd::broadcast(reductionIdentity<Type>(true));
+        auto accMax = Simd::broadcast(reductionIdentity<Type>(false));
+        for (i = 0; i + Simd::width <= size; i += Simd::width)
+        {
+          const auto v = Simd::load(data + i);
+          accMin = Simd::min(v, accMin);
+          accMax = Simd::max(v, accMax);
+        }
+        smallest = Simd::reduceMin(accMin);
+        largest = Simd::reduceMax(accMax);
+      }
+    }
+
+    for (; i < size; ++i)
+    {
+      smallest = data[i] < smallest || isNaN(smallest) ? data[i] : smallest;
+      largest = data[i] > largest || isNaN(largest) ? data[i] : largest;
+    }
+
+    if constexpr (SimdTraits<Type>::vectorized)
+    {
+      // the starting values are only kept when every element is NaN (or they were there)
+      if (smallest == reductionIdentity<Type>(true) && largest == reductionIdentity<Type>(false))
+      {
+        return { iterative::min(values), iterative::max(values) };
+      }
+    }
+
+    return { smallest, largest };
+  }
+
+
+  /*!
+    * \brief Index of the smallest element (the first one, if there are several)
+    *
+    * Two vectorized passes: the reduction finds the value, then the first match is located;
+    * the second pass usually stops early. NaNs are ignored; when every element is NaN the result is 0,
+    * so the index is always valid.
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    *
+    * \return the index of the smallest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  size_t argmin(std::span<const Type> values)
+  {
+    const auto index = findFirst(values, iterative::min(values));
+    return index < values.size() ? index : 0;
+  }
+
+
+  /*!
+    * \brief Index of the largest element (the first one, if there are several)
+    *
+    * NaNs are ignored, as in argmin(); 0 when every element is NaN.
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    *
+    * \return the index of the largest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  size_t argmax(std::span<const Type> values)
+  {
+    const auto index = findFirst(values, iterative::max(values));
+    return index < values.size() ? index : 0;
+  }
+
+
+  //! the elements of a chunk of the parallel reductions; smaller chunks are not worth the scheduling
+  static const size_t PARALLEL_REDUCTION_GRAIN = 1 << 16;
+
+  /*!
+    * \brief Multi-threaded argmin/argmax on the shared thread pool: every chunk is reduced, the results are merged in order.
+    * \tparam Type - the type of the elements
+    * \tparam Kernel - size_t(std::span<const Type>) - argmin or argmax
+    * \tparam Better - bool(Type candidate, Type current) - strict comparison selecting the winner; a number beats a NaN
+    *
+    * \param values - the elements; must not be empty
+    * \param threads - the maximum number of threads
+    * \param kernel - the single threaded kernel
+    * \param better - the comparison
+    *
+    * \return the index of the winning element (the first one, if there are several)
+    * \ingroup iterative
+    */
+  template <typename Type, class Kernel, class Better>
+  size_t parallelArgReduce(std::span<const Type> values, size_t threads, Kernel kernel, Better better)
+  {
+    std::vector<size_t> indices((values.size() + PARALLEL_REDUCTION_GRAIN - 1) / PARALLEL_REDUCTION_GRAIN);
+
+    const auto used = utility::ThreadPool::shared().parallelFor(values.size(), PARALLEL_REDUCTION_GRAIN,
+      [&](size_t chunk, size_t begin, size_t end)
+      {
+        indices[chunk] = begin + kernel(values.subspan(begin, end - begin));
+      },
+      threads
+    );
+
+    // chunks are ordered, so a strict comparison keeps the first of equal elements
+    auto result = indices[0];
+    for (size_t chunk = 1; chunk < used; ++chunk)
+    {
+      if (better(values[indices[chunk]], values[result]))
+      {
+        result = indices[chunk];
+      }
+    }
+
+    return result;
+  }
+
+
+  /*!
+    * \brief Multi-threaded index of the smallest element
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    * \param threads - the maximum number of threads
+    *
+    * \return the index of the smallest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  size_t parallelArgmin(std::span<const Type> values, size_t threads = utility::hardwareThreads())
+  {
+    return parallelArgReduce(values, threads, [](std::span<const Type> range) { return argmin(range); },
+                             [](Type candidate, Type current) { return candidate < current || (isNaN(current) && !isNaN(candidate)); });
+  }
+
+
+  /*!
+    * \brief Multi-threaded index of the largest element
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    * \param threads - the maximum number of threads
+    *
+    * \return the index of the largest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  size_t parallelArgmax(std::span<const Type> values, size_t threads = utility::hardwareThreads())
+  {
+    return parallelArgReduce(values, threads, [](std::span<const Type> range) { return argmax(range); },
+                             [](Type candidate, Type current) { return candidate > current || (isNaN(current) && !isNaN(candidate)); });
+  }
+
+
+  /*!
+    * \brief Multi-threaded value reduction on the shared thread pool: every chunk is reduced, the results are reduced again.
+    * \tparam Type - the type of the elements
+    * \tparam Kernel - Type(std::span<const Type>) - min or max
+    *
+    * \param values - the elements; must not be empty
+    * \param threads - the maximum number of threads
+    * \param kernel - the single threaded kernel
+    *
+    * \return the reduced value
+    * \ingroup iterative
+    */
+  template <typename Type, class Kernel>
+  Type parallelReduce(std::span<const Type> values, size_t threads, Kernel kernel)
+  {
+    std::vector<Type> partial((values.size() + PARALLEL_REDUCTION_GRAIN - 1) / PARALLEL_REDUCTION_GRAIN);
+
+    const auto used = utility::ThreadPool::shared().parallelFor(values.size(), PARALLEL_REDUCTION_GRAIN,
+      [&](size_t chunk, size_t begin, size_t end)
+      {
+        partial[chunk] = kernel(values.subspan(begin, end - begin));
+      },
+      threads
+    );
+
+    return kernel(std::span<const Type>(partial.data(), used));
+  }
+
+
+  /*!
+    * \brief Multi-threaded search for the smallest element
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    * \param threads - the maximum number of threads
+    *
+    * \return the smallest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  Type parallelMin(std::span<const Type> values, size_t threads = utility::hardwareThreads())
+  {
+    return parallelReduce(values, threads, [](std::span<const Type> range) { return iterative::min(range); });
+  }
+
+
+  /*!
+    * \brief Multi-threaded search for the largest element
+    * \tparam Type - the type of the elements
+    *
+    * \param values - the elements; must not be empty
+    * \param threads - the maximum number of threads
+    *
+    * \return the largest element
+    * \ingroup iterative
+    */
+  template <typename Type>
+  Type parallelMax(std::span<const Type> values, size_t threads = utility::hardwareThreads())
+  {
+    return parallelReduce(values, threads, [](std::span<const Type> range) { return iterative::max(range); });
+  }
+
+  namespace unitTest {
+    double simdMinMax();
+  }
+}
+
+#endif // !__SIMD_MIN_MAX_H__
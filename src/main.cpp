@@ -3,6 +3,8 @@
 #include <random>
 #include <iostream>
 #include <chrono>
+#include <fstream>
+#include <string>
 
 #include "stochastic/RandomSearch.h"
 #include "stochastic/AdaptiveRandomSearch.h"
@@ -11,19 +13,39 @@
 #include "statistics/clock.h"
 #include "statistics/benchmark.h"
 #include "stochastic/hillClimbing.h"
+#include "stochastic/IslandHillClimbing.h"
+#include "stochastic/Portfolio.h"
+#include "stochastic/ParticleSwarm.h"
+#include "stochastic/DifferentialEvolution.h"
+#include "stochastic/CmaEvolutionStrategy.h"
 #include "problems/tsp/nearestNeighbour.h"
 #include "problems/tsp/twoOpt.h"
+#include "problems/tsp/iteratedLocalSearch.h"
+#include "problems/tsp/batch.h"
+#include "problems/tsp/generators.h"
+#include "utility/Arena.h"
 
 int main(int argc, TCHAR** a)
 {
   randomGenerators::DefaultRandomEngine::get();
 
+  // the vectorized reductions against their scalar reference (asserts)
+  iterative::unitTest::simdMinMax();
+
+  // the island model reaches the OneMax optimum, reproducibly (asserts)
+  stochastic::unitTest::islandClimbHill();
+
   // stochastic::unitTest::climbHill();
 
   statistics::Benchmark benchmark;
-  //benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics::AlgorithmStatistics(100, "RandomSearch", false, stochastic::unitTest::randomSearchMin));
-  //benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics::AlgorithmStatistics(100, "AdaptiveRandomSearch", false, stochastic::unitTest::adaptiveRandomSearchMin));
-  //benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics::AlgorithmStatistics(100, "Iterative", true, iterative::unitTest::iterativeMin));
+  // the rows written by --export and checked by --compare
+  benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics(100, "RandomSearch", false, stochastic::unitTest::randomSearchMin));
+  benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics(100, "AdaptiveRandomSearch", false, stochastic::unitTest::adaptiveRandomSearchMin));
+  benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics(100, "Iterative", true, iterative::unitTest::iterativeMin));
+  benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics(100, "ParticleSwarm", false, stochastic::unitTest::particleSwarmMin));
+  benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics(100, "DifferentialEvolution", false, stochastic::unitTest::differentialEvolutionMin));
+  benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics(100, "CmaEvolutionStrategy", false, stochastic::unitTest::cmaEvolutionStrategyMin));
+  benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics(100, "Portfolio", false, stochastic::unitTest::portfolioMin));
   
   
   //benchmark.addAlgorithm(statistics::Benchmark::AlgorithmStatistics::AlgorithmStatistics(100, "hillClimb", true, stochastic::unitTest::climbHill));  
@@ -34,9 +56,11 @@ int main(int argc, TCHAR** a)
   problems::tsp::TourArray bestTour;
   int bestTourIndex = 0;
 
+  // the per start scratch of the nearest neighbour runs is recycled by the arena
+  utility::RunArena arena;
   FOR(i, problems::tsp::Berlin52.size())
   {    
-    problems::tsp::nearestNeighbour(problems::tsp::Berlin52, i, tour, tourDistance);
+    problems::tsp::nearestNeighbour(problems::tsp::Berlin52, i, tour, tourDistance, arena.resource());
     if (tourDistance < minTourDistance)
     {
       minTourDistance = tourDistance;
@@ -45,7 +69,25 @@ int main(int argc, TCHAR** a)
     }
   }
 
-  problems::tsp::twoOptMove(problems::tsp::Berlin52, bestTour);
+  // race first and best improvement 2-opt from the best start, keep the shorter tour
+  stochastic::Portfolio<problems::tsp::TourArray> twoOptPortfolio;
+  twoOptPortfolio
+    .add([](auto& lane, problems::tsp::TourArray& tour)
+      {
+        problems::tsp::firstTwoOptMove(problems::tsp::Berlin52, tour, lane.criteria());
+        return problems::tsp::tourLength(problems::tsp::Berlin52, tour);
+      }, bestTour)
+    .add([](auto& lane, problems::tsp::TourArray& tour)
+      {
+        problems::tsp::twoOptMove(problems::tsp::Berlin52, tour, lane.criteria());
+        return problems::tsp::tourLength(problems::tsp::Berlin52, tour);
+      }, bestTour);
+  bestTour = twoOptPortfolio.run(utility::StoppingCriteria()).solution;
+
+  // kick the 2-opt local optimum out of its basin
+  problems::tsp::IteratedLocalSearchOptions ilsOptions;
+  ilsOptions.kicks = 20000;
+  problems::tsp::iteratedLocalSearch(problems::tsp::Berlin52, bestTour, ilsOptions, arena.resource());
 
   for (auto t : bestTour)
   {
@@ -60,7 +102,52 @@ int main(int argc, TCHAR** a)
 
   auto d = problems::tsp::tourLength(problems::tsp::Berlin52, bestTour);
 
+  // many small independent routes, solved in one call
+  problems::tsp::PackedInstances routes;
+  FOR(i, 10000)
+  {
+    routes.add(problems::tsp::uniformCities(5 + i % 40, 1000, i));
+  }
+  std::vector<size_t> routeTours(routes.cities.size());
+  std::vector<double> routeLengths(routes.size());
+  const auto batchStart = std::chrono::steady_clock::now();
+  problems::tsp::solveBatch(routes.offsets, routes.cities, routeTours, routeLengths);
+  const std::chrono::duration<double> batchTime = std::chrono::steady_clock::now() - batchStart;
+  std::cout << routes.size() / batchTime.count() << " instances/s" << std::endl;
+
   benchmark.printResults();
 
+  // --export <prefix> writes <prefix>.csv and <prefix>.json; --compare <csv> checks against a previous export
+  for (int arg = 1; arg + 1 < argc; arg += 2)
+  {
+    const std::string option = a[arg];
+    if (option == "--export")
+    {
+      std::ofstream csv(std::string(a[arg + 1]) + ".csv");
+      benchmark.writeCsv(csv);
+      std::ofstream json(std::string(a[arg + 1]) + ".json");
+      benchmark.writeJson(json);
+    }
+    else if (option == "--compare")
+    {
+      std::ifstream previous(a[arg + 1]);
+      std::string error;
+      const auto regressions = benchmark.compare(previous, error);
+      if (!regressions)
+      {
+        std::cout << "cannot compare with " << a[arg + 1] << ": " << error << std::endl;
+        return 2;
+      }
+      for (auto& r : *regressions)
+      {
+        std::cout << "REGRESSION " << r.name << ": " << r.metric << " " << r.previous << " -> " << r.current << std::endl;
+      }
+      if (!regressions->empty())
+      {
+        return 1;
+      }
+    }
+  }
+
   return 0;
 }
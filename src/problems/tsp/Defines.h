@@ -10,7 +10,7 @@ namespace problems {
       \ingroup problems
   */
   namespace tsp {
-    using City = struct
+    struct City
     {
       double x = 0, y = 0;
     };
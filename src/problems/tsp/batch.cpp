@@ -0,0 +1,89 @@
+#include <algorithm>
+
+#include "../../random_generators/vectorGenerator.h"
+#include "../../statistics/trace.h"
+#include "../../utility/Arena.h"
+#include "../../utility/ThreadPool.h"
+#include "batch.h"
+#include "heldKarp.h"
+#include "nearestNeighbour.h"
+
+namespace {
+  using namespace problems::tsp;
+
+  // what a thread keeps from one instance to the next; the arena is emptied after every instance
+  struct Scratch
+  {
+    Scratch() = default;
+
+    // every copy (a slot of utility::WorkerLocal) has its own arena
+    Scratch(const Scratch&) :
+      Scratch()
+    {
+      ;
+    }
+
+    utility::RunArena arena;
+    Cities cities;
+    TourArray tour;
+  };
+}
+
+bool problems::tsp::solveBatch(std::span<const size_t> offsets, std::span<const City> cities, std::span<size_t> tours, std::span<double> lengths,
+                               const BatchOptions& options)
+{
+  TRACE_ZONE("solveBatch");
+
+  if (offsets.empty() || offsets.front() != 0 || !std::is_sorted(offsets.begin(), offsets.end()) || offsets.back() > cities.size() ||
+      offsets.back() > tours.size() || (!lengths.empty() && lengths.size() < offsets.size() - 1))
+  {
+    return false;
+  }
+
+  const auto count = offsets.size() - 1;
+  const auto exactCities = std::min(options.exactCities, MAX_HELD_KARP_CITIES);
+
+  auto& pool = utility::ThreadPool::shared();
+  const auto concurrency = std::min(options.threads ? options.threads : pool.concurrency(), pool.concurrency());
+  utility::WorkerLocal<Scratch> scratch(pool);
+
+  pool.parallelFor(count, std::max<size_t>(count / (8 * concurrency), 1), [&](size_t, size_t begin, size_t end)
+    {
+      auto& local = scratch.local();
+      auto improvement = options.improvement;
+      for (auto i = begin; i < end; ++i)
+      {
+        const auto first = offsets[i];
+        const auto size = offsets[i + 1] - first;
+        local.cities.assign(cities.begin() + first, cities.begin() + first + size);
+
+        // every tour of up to 3 cities is optimal, heldKarp returns it right away
+        auto length = 0.0;
+        if (size <= std::max<size_t>(exactCities, 3))
+        {
+          heldKarp(local.cities, local.tour, length, 1, local.arena.resource());
+        }
+        else
+        {
+          if (options.seed)
+          {
+            improvement.seed = randomGenerators::mixSeed(*options.seed, i);
+          }
+          nearestNeighbour(local.cities, 0, local.tour, length, local.arena.resource());
+          iteratedLocalSearch(local.cities, local.tour, improvement, local.arena.resource());
+          length = tourLength(local.cities, local.tour);
+        }
+
+        std::copy(local.tour.begin(), local.tour.end(), tours.begin() + first);
+        if (!lengths.empty())
+        {
+          lengths[i] = length;
+        }
+
+        // the pool hands the blocks of large buffers back to the region, which never reuses them: start over
+        local.arena.release();
+      }
+    }, concurrency);
+
+  return true;
+}
@@ -0,0 +1,72 @@
+#ifndef __TSP_BATCH_H__
+#define __TSP_BATCH_H__
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../../utility/Defines.h"
+#include "Defines.h"
+#include "iteratedLocalSearch.h"
+
+namespace problems {
+  namespace tsp {
+
+    /*! \class PackedInstances "batch.h"
+      * \brief Many instances in two buffers: the cities of all of them back to back, and where each one starts.
+      * \ingroup tsp
+      */
+    struct PackedInstances
+    {
+      std::vector<size_t> offsets = { 0 };/*!< instance i is cities[offsets[i] .. offsets[i + 1]) */
+      Cities cities;/*!< the cities of every instance */
+
+      //! appends an instance
+      void add(const Cities& instance)
+      {
+        cities.insert(cities.end(), instance.begin(), instance.end());
+        offsets.push_back(cities.size());
+      }
+
+      //! the number of instances
+      size_t size() const { return offsets.size() - 1; }
+    };
+
+
+    /*! \class BatchOptions "batch.h"
+      * \brief How the instances of a batch are solved.
+      * \ingroup tsp
+      */
+    struct BatchOptions
+    {
+      size_t exactCities = 12;/*!< the instances up to this size are solved exactly (heldKarp); at most MAX_HELD_KARP_CITIES */
+      IteratedLocalSearchOptions improvement = { .kicks = 100 };/*!< the larger ones: nearestNeighbour, then iteratedLocalSearch */
+      size_t threads = 0;/*!< the maximum number of threads; 0: the whole shared pool */
+      std::optional<uint64_t> seed;/*!< instance i is improved with the seed randomGenerators::mixSeed(seed, i); improvement.seed when empty */
+    };
+
+    /*!
+      * \brief Solves a batch of independent instances, in parallel
+      *
+      * The instances are spread over the shared utility::ThreadPool. Every thread keeps a copy of the instance
+      * and the tour from one instance to the next, and takes the solvers' working memory from its own
+      * utility::RunArena, released after every instance: a few allocations per instance, and the memory of a
+      * batch is bounded by its largest instances. With a seed, the tours do not depend on the number of
+      * threads; the threads' random engines are never reseeded.
+      *
+      * \param[in] offsets - instance i is cities[offsets[i] .. offsets[i + 1]); offsets[0] is 0
+      * \param[in] cities - the cities of every instance, back to back
+      * \param[out] tours - the tour of instance i at tours[offsets[i] .. offsets[i + 1]), by index in the instance
+      * \param[out] lengths - the length of every tour; may be empty
+      * \param[in] options - how the instances are solved
+      *
+      * \return false (and nothing is solved) when the buffers do not match the offsets
+      * \ingroup tsp
+      */
+    bool solveBatch(std::span<const size_t> offsets, std::span<const City> cities, std::span<size_t> tours, std::span<double> lengths,
+                    const BatchOptions& options = BatchOptions());
+  }
+}
+
+#endif // !__TSP_BATCH_H__
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "generators.h"
+
+problems::tsp::Cities problems::tsp::uniformCities(size_t count, double side, uint64_t seed)
+{
+  std::mt19937_64 engine(seed);
+  std::uniform_real_distribution<double> coordinate(0, side);
+
+  Cities cities(count);
+  for (auto& city : cities)
+  {
+    city.x = coordinate(engine);
+    city.y = coordinate(engine);
+  }
+
+  return cities;
+}
+
+problems::tsp::Cities problems::tsp::clusteredCities(size_t count, size_t clusters, double side, double spread, uint64_t seed)
+{
+  std::mt19937_64 engine(seed);
+  std::uniform_real_distribution<double> coordinate(0, side);
+  std::normal_distribution<double> offset(0, spread * side);
+
+  Cities centres(std::max<size_t>(clusters, 1));
+  for (auto& centre : centres)
+  {
+    centre.x = coordinate(engine);
+    centre.y = coordinate(engine);
+  }
+
+  std::uniform_int_distribution<size_t> pick(0, centres.size() - 1);
+  const auto limit = std::nextafter(side, 0.0);
+
+  Cities cities(count);
+  for (auto& city : cities)
+  {
+    const auto& centre = centres[pick(engine)];
+    city.x = std::clamp(centre.x + offset(engine), 0.0, limit);
+    city.y = std::clamp(centre.y + offset(engine), 0.0, limit);
+  }
+
+  return cities;
+}
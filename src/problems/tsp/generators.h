@@ -0,0 +1,43 @@
+#ifndef __TSP_GENERATORS_H__
+#define __TSP_GENERATORS_H__
+
+#include <cstdint>
+
+#include "../../utility/Defines.h"
+#include "Defines.h"
+
+namespace problems {
+  namespace tsp {
+
+    /*!
+      * \brief Generates cities uniformly distributed over a square
+      *
+      * \param[in] count - the number of cities
+      * \param[in] side - the side of the square [0, side) x [0, side)
+      * \param[in] seed - the seed; the same seed always yields the same cities
+      *
+      * \return the cities
+      * \ingroup tsp
+      */
+    Cities uniformCities(size_t count, double side, uint64_t seed);
+
+    /*!
+      * \brief Generates cities grouped in normally distributed clusters over a square
+      *
+      * Closer to real instances (towns around cities) than uniform cities; the cluster
+      * centres are uniform, the cities are clamped to the square.
+      *
+      * \param[in] count - the number of cities
+      * \param[in] clusters - the number of clusters
+      * \param[in] side - the side of the square [0, side) x [0, side)
+      * \param[in] spread - the standard deviation of a cluster, relative to side
+      * \param[in] seed - the seed; the same seed always yields the same cities
+      *
+      * \return the cities
+      * \ingroup tsp
+      */
+    Cities clusteredCities(size_t count, size_t clusters, double side, double spread, uint64_t seed);
+  }
+}
+
+#endif // !__TSP_GENERATORS_H__
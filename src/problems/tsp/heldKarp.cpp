@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <numeric>
+
+#include "../../iterative/SimdMinMax.h"
+#include "../../statistics/trace.h"
+#include "../../utility/FixedDimension.h"
+#include "../../utility/ThreadPool.h"
+#include "heldKarp.h"
+
+namespace {
+  using Subset = uint32_t;
+
+  const float INFINITE = std::numeric_limits<float>::infinity();
+
+  // the floats of a register, 8 without vector registers
+  template <class Value = float>
+  constexpr size_t simdWidth()
+  {
+    if constexpr (iterative::SimdTraits<Value>::vectorized)
+    {
+      return iterative::SimdTraits<Value>::width;
+    }
+    else
+    {
+      return 8;
+    }
+  }
+
+  // the other cities of the largest instance: the bits of a subset
+  constexpr size_t MAX_OTHERS = problems::tsp::MAX_HELD_KARP_CITIES - 1;
+
+  // the longest row: the other cities, padded to whole registers
+  constexpr size_t MAX_STRIDE = (MAX_OTHERS + simdWidth() - 1) / simdWidth() * simdWidth();
+
+  using Binomials = std::array<std::array<uint32_t, MAX_OTHERS + 2>, MAX_OTHERS + 1>;
+
+  Binomials computeBinomials()
+  {
+    Binomials c{};
+    for (size_t i = 0; i <= MAX_OTHERS; ++i)
+    {
+      c[i][0] = 1;
+      for (size_t k = 1; k <= i; ++k)
+      {
+        c[i][k] = c[i - 1][k - 1] + (k < i ? c[i - 1][k] : 0);
+      }
+    }
+
+    return c;
+  }
+
+  const Binomials& binomials()
+  {
+    static const Binomials s_binomials = computeBinomials();
+    return s_binomials;
+  }
+
+  /*
+    The rank of a subset among the subsets of its size, in increasing order (colex): the sum of C(bit, index + 1)
+    over its bits. Two table lookups: the low bits give their terms directly, the high bits give theirs once
+    the number of low bits (the index of the first high bit) is known.
+  */
+  class Ranks
+  {
+  public:
+    static const size_t LOW_BITS = 12;
+
+    explicit Ranks(const Binomials& c, size_t bits = MAX_OTHERS) :
+      _highBits(bits > LOW_BITS ? bits - LOW_BITS : 0)
+    , _low(size_t(1) << LOW_BITS)
+    , _high((LOW_BITS + 1) << _highBits)
+    {
+      FOR(low, _low.size())
+      {
+        _low[low] = sum(static_cast<Subset>(low), 0, 0, c);
+      }
+      FOR(lowCount, LOW_BITS + 1)
+      {
+        FOR(high, size_t(1) << _highBits)
+        {
+          _high[(lowCount << _highBits) + high] = sum(static_cast<Subset>(high), LOW_BITS, lowCount, c);
+        }
+      }
+    }
+
+    uint32_t operator()(Subset subset) const
+    {
+      const auto low = subset & ((Subset(1) << LOW_BITS) - 1);
+      return _low[low] + _high[(static_cast<size_t>(std::popcount(low)) << _highBits) + (subset >> LOW_BITS)];
+    }
+
+  protected:
+    // the terms of the bits of subset, moved up by offset, the first one having the index first
+    static uint32_t sum(Subset subset, size_t offset, size_t first, const Binomials& c)
+    {
+      uint32_t result = 0;
+      for (auto index = first + 1; subset; subset &= subset - 1, ++index)
+      {
+        result += c[std::countr_zero(subset) + offset][index];
+      }
+
+      return result;
+    }
+
+    size_t _highBits;
+    std::vector<uint32_t> _low;
+    std::vector<uint32_t> _high;
+  };
+
+  // the tables do not depend on the instance: built once
+  const Ranks& ranks()
+  {
+    static const Ranks s_ranks(binomials());
+    return s_ranks;
+  }
+
+  // the subset of the given size and rank
+  Subset unrank(uint32_t r, size_t size, const Binomials& c)
+  {
+    Subset subset = 0;
+    auto bit = MAX_OTHERS;
+    for (auto index = size; index > 0; --index)
+    {
+      while (c[bit][index] > r)
+      {
+        --bit;
+      }
+      subset |= Subset(1) << bit;
+      r -= c[bit][index];
+    }
+
+    return subset;
+  }
+
+  // the next subset of the same size, in increasing order (Gosper's hack)
+  Subset nextSubset(Subset subset)
+  {
+    const auto low = subset & (~subset + 1);
+    const auto ripple = subset + low;
+    return ripple | (((ripple ^ subset) >> 2) / low);
+  }
+
+  /*
+    Relaxes the cities from a row of the previous layer: for every city j, best[j] = min over k in the subset of
+    row[k] + distances[k][j], and from[j] is the first k reaching it. Vectorized over j, so there is no horizontal
+    reduction; the row is only read at the cities of the subset. A row is Registers whole registers (a compile time
+    count keeps the accumulators in registers).
+  */
+  template <size_t Registers, class Value = float>
+  void relax(const Value* row, Subset subset, const Value* distances, Value* best, Value* from)
+  {
+    using Simd = iterative::SimdTraits<Value>;
+    constexpr auto size = Registers * simdWidth<Value>();
+    if constexpr (Simd::vectorized)
+    {
+      typename Simd::Register costs[Registers], origins[Registers];
+      utility::unroll<Registers>([&](auto r)
+        {
+          costs[r] = Simd::broadcast(INFINITE);
+          origins[r] = Simd::broadcast(Value(0));
+        });
+
+      for (; subset; subset &= subset - 1)
+      {
+        const auto k = std::countr_zero(subset);
+        const auto cost = Simd::broadcast(row[k]);
+        const auto origin = Simd::broadcast(static_cast<Value>(k));
+        const auto distance = distances + k * size;
+        utility::unroll<Registers>([&](auto r)
+          {
+            const auto candidate = Simd::add(cost, Simd::load(distance + r * Simd::width));
+            origins[r] = Simd::select(Simd::less(candidate, costs[r]), origin, origins[r]);
+            costs[r] = Simd::min(costs[r], candidate);
+          });
+      }
+
+      utility::unroll<Registers>([&](auto r)
+        {
+          Simd::store(best + r * Simd::width, costs[r]);
+          Simd::store(from + r * Simd::width, origins[r]);
+        });
+    }
+    else
+    {
+      std::fill(best, best + size, INFINITE);
+      std::fill(from, from + size, Value(0));
+      for (; subset; subset &= subset - 1)
+      {
+        const auto k = std::countr_zero(subset);
+        FOR(j, size)
+        {
+          const auto candidate = row[k] + distances[k * size + j];
+          if (candidate < best[j])
+          {
+            best[j] = candidate;
+            from[j] = static_cast<Value>(k);
+          }
+        }
+      }
+    }
+  }
+
+  /*
+    One layer: every (subset, j) of the layer is written once, from the row of subset \ {j} in the previous layer.
+    The rows of the previous layer are split between the threads.
+  */
+  template <size_t Registers>
+  void layer(size_t size, size_t m, const Binomials& c, const Ranks& rank, const float* distances, const float* previous, float* current,
+             uint8_t* predecessor, utility::ThreadPool& pool, size_t concurrency)
+  {
+    constexpr auto stride = Registers * simdWidth();
+    const auto all = static_cast<Subset>((Subset(1) << m) - 1);
+    const auto rows = c[m][size - 1];
+    const auto grain = std::max<size_t>(rows / (8 * concurrency), 64);
+    pool.parallelFor(rows, grain, [&](size_t, size_t begin, size_t end)
+      {
+        alignas(utility::CACHE_LINE_SIZE) float best[stride];
+        alignas(utility::CACHE_LINE_SIZE) float from[stride];
+
+        auto subset = unrank(static_cast<uint32_t>(begin), size - 1, c);
+        for (auto r = begin; r < end; ++r, subset = nextSubset(subset))
+        {
+          relax<Registers>(previous + r * stride, subset, distances, best, from);
+
+          for (auto outside = ~subset & all; outside; outside &= outside - 1)
+          {
+            const auto j = static_cast<size_t>(std::countr_zero(outside));
+            const auto target = rank(subset | Subset(1) << j);
+            current[target * stride + j] = best[j];
+            predecessor[target * m + j] = static_cast<uint8_t>(from[j]);
+          }
+        }
+      }, concurrency);
+  }
+}
+
+bool problems::tsp::heldKarp(const Cities& cities, TourArray& tour, double& tourDistance, size_t threads, std::pmr::memory_resource* scratch)
+{
+  TRACE_ZONE("heldKarp");
+
+  const auto n = cities.size();
+  if (n > MAX_HELD_KARP_CITIES)
+  {
+    return false;
+  }
+
+  if (n <= 3)
+  {
+    // every tour is optimal
+    tour.resize(n);
+    std::iota(tour.begin(), tour.end(), size_t(0));
+    tourDistance = tourLength(cities, tour);
+    return true;
+  }
+
+  // city k + 1 is the bit k of a subset; the distance rows are padded with zeros to whole registers
+  const auto m = n - 1;
+  const auto width = simdWidth();
+  const auto stride = (m + width - 1) / width * width;
+  const auto& c = binomials();
+  const auto& rank = ranks();
+
+  std::pmr::vector<float> distances(m * stride, 0.0f, scratch);
+  FOR(j, m)
+  {
+    FOR(k, m)
+    {
+      distances[j * stride + k] = static_cast<float>(distance(cities[j + 1], cities[k + 1]));
+    }
+  }
+
+  // the first row of every layer in the predecessor table
+  std::pmr::vector<size_t> layerStart(m + 2, 0, scratch);
+  for (size_t size = 1; size <= m; ++size)
+  {
+    layerStart[size + 1] = layerStart[size] + c[m][size];
+  }
+  std::pmr::vector<uint8_t> predecessor(layerStart[m + 1] * m, scratch);
+
+  // a row of a layer only holds the costs of the cities of its subset, the other entries are never read
+  const auto widest = c[m][m / 2];
+  std::pmr::vector<float> previous(widest * stride, scratch);
+  std::pmr::vector<float> current(widest * stride, scratch);
+
+  // layer 1: straight from city 0; the rank of {j} is j
+  FOR(j, m)
+  {
+    previous[j * stride + j] = static_cast<float>(distance(cities[0], cities[j + 1]));
+  }
+
+  auto& pool = utility::ThreadPool::shared();
+  const auto concurrency = std::min(threads ? threads : pool.concurrency(), pool.concurrency());
+  for (size_t size = 2; size <= m; ++size)
+  {
+    utility::dispatchDimension<MAX_STRIDE / simdWidth()>(stride / width, [&](auto registers)
+      {
+        layer<registers>(size, m, c, rank, distances.data(), previous.data(), current.data(), &predecessor[layerStart[size] * m], pool, concurrency);
+      }, []() { ; });
+
+    std::swap(previous, current);
+  }
+
+  // close the tour: the last layer has one row, every city
+  size_t last = 0;
+  auto length = INFINITE;
+  FOR(j, m)
+  {
+    const auto cost = previous[j] + static_cast<float>(distance(cities[j + 1], cities[0]));
+    if (cost < length)
+    {
+      length = cost;
+      last = j;
+    }
+  }
+
+  tour.resize(n);
+  tour[0] = 0;
+  auto subset = static_cast<Subset>((Subset(1) << m) - 1);
+  size_t j = last;
+  for (auto position = m; position > 0; --position)
+  {
+    tour[position] = j + 1;
+    const auto size = static_cast<size_t>(std::popcount(subset));
+    const auto next = size > 1 ? predecessor[(layerStart[size] + rank(subset)) * m + j] : 0;
+    subset &= ~(Subset(1) << j);
+    j = next;
+  }
+
+  tourDistance = tourLength(cities, tour);
+  return true;
+}
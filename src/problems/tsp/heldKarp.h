@@ -0,0 +1,43 @@
+#ifndef __TSP_HELD_KARP_H__
+#define __TSP_HELD_KARP_H__
+
+#include <memory_resource>
+
+#include "../../utility/Defines.h"
+#include "Defines.h"
+
+namespace problems {
+  namespace tsp {
+
+    //! the largest instance heldKarp solves; the memory doubles with every city (about 30 MB at 20 cities, 450 MB at 24)
+    static const size_t MAX_HELD_KARP_CITIES = 24;
+
+    /*!
+      * \brief Solves the Traveling Salesman Problem exactly, by the Held-Karp dynamic programming
+      *
+      * The tour starts at city 0; cost(S, j) is the shortest path from city 0 through the cities of the subset S,
+      * ending at j. The subsets are processed layer by layer (by size), and a layer only needs the previous one:
+      * the subsets of a layer are indexed by their rank among the subsets of that size (the combinatorial number
+      * system), so only two layers of float costs are kept, plus a byte per (subset, city) for the backtracking.
+      * A row of the previous layer relaxes every city outside its subset at once, vectorized over those cities (a
+      * running minimum per register, no horizontal reduction); the rows are independent and spread over the shared
+      * utility::ThreadPool, and every cost of the next layer is written by exactly one of them.
+      *
+      * The costs are float: the tour is optimal up to their rounding (a tour within about 1e-6 of the optimum,
+      * relative, may be returned instead).
+      *
+      * \param[in] cities - the cities in defining the problem; at most MAX_HELD_KARP_CITIES
+      * \param[out] tour - the optimal tour, starting at city 0
+      * \param[out] tourDistance - the tour distance
+      * \param[in] threads - the maximum number of threads; 0 for the whole shared pool
+      * \param[in] scratch - where the working memory comes from (e.g. utility::RunArena::resource())
+      *
+      * \return false (and the tour is left untouched) when there are too many cities
+      * \ingroup tsp
+      */
+    bool heldKarp(const Cities& cities, TourArray& tour, double& tourDistance, size_t threads = 0,
+                  std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+  }
+}
+
+#endif // !__TSP_HELD_KARP_H__
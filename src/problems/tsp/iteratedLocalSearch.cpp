@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+
+#include "../../random_generators/vectorGenerator.h"
+#include "../../statistics/trace.h"
+#include "iteratedLocalSearch.h"
+
+namespace {
+  using namespace problems::tsp;
+
+  // gains below it are rounding noise; taking them could cycle
+  const double EPSILON = 1e-9;
+
+  // a uniform integer in [0, count), count < 2^32
+  size_t randomBelow(randomGenerators::BulkRandomEngine& engine, size_t count)
+  {
+    return static_cast<size_t>(((engine() >> 32) * count) >> 32);
+  }
+
+  /*
+    The tour with the position of every city, the candidate lists and the queue of dirty cities.
+    Every reversal done while journaling is recorded, so the moves since a checkpoint can be undone.
+  */
+  class LocalSearch
+  {
+  public:
+    LocalSearch(const Cities& cities, TourArray& tour, size_t neighbours, std::pmr::memory_resource* scratch) :
+      _cities(cities)
+    , _tour(tour)
+    , _n(tour.size())
+    , _position(_n, scratch)
+    , _neighbours(scratch)
+    , _queue(_n, scratch)
+    , _queued(_n, 0, scratch)
+    , _journal(scratch)
+    {
+      for (size_t i = 0; i < _n; ++i)
+      {
+        _position[_tour[i]] = i;
+      }
+
+      _count = std::min(neighbours, _n - 1);
+      nearestNeighbourLists(_cities, _count, _neighbours, scratch);
+      _length = tourLength(_cities, _tour);
+    }
+
+    double length() const { return _length; }
+
+    void markAll()
+    {
+      for (size_t i = 0; i < _n; ++i)
+      {
+        push(_tour[i]);
+      }
+    }
+
+    // 2-opt until no dirty city is left; false when stopped
+    bool descend(utility::StoppingCriteria& stopping)
+    {
+      while (_pending)
+      {
+        const auto city = _queue[_head];
+        _head = (_head + 1) % _n;
+        --_pending;
+        _queued[city] = 0;
+
+        improve(city);
+        if (stopping.evaluated())
+        {
+          return false;
+        }
+      }
+
+      return true;
+    }
+
+    // a double bridge over the segments [p + 1, p + first] and [p + first + 1, p + first + second]: A B C D -> A C B D
+    void kick(size_t p, size_t first, size_t second)
+    {
+      const auto a = _tour[p];
+      const auto b0 = at(p + 1), b1 = at(p + first);
+      const auto c0 = at(p + first + 1), c1 = at(p + first + second);
+      const auto d0 = at(p + first + second + 1);
+
+      _length += (edge(a, c0) + edge(c1, b0) + edge(b1, d0)) - (edge(a, b0) + edge(b1, c0) + edge(c1, d0));
+
+      // swapping two adjacent blocks is three reversals, all of them short
+      reverse((p + 1) % _n, (p + first) % _n);
+      reverse((p + first + 1) % _n, (p + first + second) % _n);
+      reverse((p + 1) % _n, (p + first + second) % _n);
+
+      for (auto city : { a, b0, b1, c0, c1, d0 })
+      {
+        push(city);
+      }
+    }
+
+    void startJournal()
+    {
+      _journal.clear();
+      _journaling = true;
+    }
+
+    // undoes the reversals since startJournal(); a reversal is its own inverse
+    void undo(double length)
+    {
+      for (auto r = _journal.rbegin(); r != _journal.rend(); ++r)
+      {
+        reverse(r->first, r->second, false);
+      }
+      _length = length;
+    }
+
+    // replays the reversals undone
+    void redo(double length)
+    {
+      for (auto& r : _journal)
+      {
+        reverse(r.first, r.second, false);
+      }
+      _length = length;
+    }
+
+  protected:
+    double edge(size_t c0, size_t c1) const { return distance(_cities[c0], _cities[c1]); }
+    size_t at(size_t index) const { return _tour[index % _n]; }
+    size_t next(size_t city) const { return at(_position[city] + 1); }
+    size_t previous(size_t city) const { return at(_position[city] + _n - 1); }
+
+    void push(size_t city)
+    {
+      if (!_queued[city])
+      {
+        _queued[city] = 1;
+        _queue[(_head + _pending) % _n] = city;
+        ++_pending;
+      }
+    }
+
+    // reverses the tour between the positions from and to (inclusive, cyclic)
+    void reverse(size_t from, size_t to, bool journal = true)
+    {
+      if (journal && _journaling)
+      {
+        _journal.emplace_back(from, to);
+      }
+
+      const auto size = (to + _n - from) % _n + 1;
+      auto left = from, right = to;
+      for (size_t i = 0; i < size / 2; ++i)
+      {
+        std::swap(_tour[left], _tour[right]);
+        _position[_tour[left]] = left;
+        _position[_tour[right]] = right;
+        left = (left + 1) % _n;
+        right = (right + _n - 1) % _n;
+      }
+    }
+
+    // a 2-opt move reversing [from, to] or, the same tour the other way around, the rest of it: whichever is shorter
+    void reverseShorter(size_t from, size_t to)
+    {
+      const auto size = (to + _n - from) % _n + 1;
+      if (2 * size > _n)
+      {
+        reverse((to + 1) % _n, (from + _n - 1) % _n);
+      }
+      else
+      {
+        reverse(from, to);
+      }
+    }
+
+    // the first improving 2-opt move of an edge of city to one of its candidates
+    bool improve(size_t a)
+    {
+      const auto candidates = &_neighbours[a * _count];
+      FOR(direction, 2)
+      {
+        const auto forward = direction == 0;
+        const auto an = forward ? next(a) : previous(a);
+        const auto removed = edge(a, an);
+
+        for (size_t k = 0; k < _count; ++k)
+        {
+          const auto c = candidates[k];
+
+          // the candidates are sorted: no farther one can shorten the edge
+          const auto partial = removed - edge(a, c);
+          if (partial <= EPSILON)
+          {
+            break;
+          }
+
+          const auto cn = forward ? next(c) : previous(c);
+          if (c == an || cn == a)
+          {
+            continue;
+          }
+
+          const auto gain = partial + edge(c, cn) - edge(an, cn);
+          if (gain > EPSILON)
+          {
+            // forward: a an .. c cn -> a c .. an cn; backward: cn c .. an a -> cn an .. c a
+            if (forward)
+            {
+              reverseShorter(_position[an], _position[c]);
+            }
+            else
+            {
+              reverseShorter(_position[c], _position[an]);
+            }
+
+            _length -= gain;
+            for (auto city : { a, an, c, cn })
+            {
+              push(city);
+            }
+            return true;
+          }
+        }
+      }
+
+      return false;
+    }
+
+    const Cities& _cities;
+    TourArray& _tour;
+    size_t _n;
+    double _length = 0;
+    std::pmr::vector<size_t> _position;/* the index of every city in the tour */
+    std::pmr::vector<size_t> _neighbours;/* _count candidates per city */
+    size_t _count = 0;
+    std::pmr::vector<size_t> _queue;/* a ring: every city is queued at most once */
+    std::pmr::vector<char> _queued;
+    size_t _head = 0;
+    size_t _pending = 0;
+    std::pmr::vector<std::pair<size_t, size_t>> _journal;/* the reversals since startJournal() */
+    bool _journaling = false;
+  };
+}
+
+void problems::tsp::nearestNeighbourLists(const Cities& cities, size_t count, std::pmr::vector<size_t>& neighbours, std::pmr::memory_resource* scratch)
+{
+  const auto n = cities.size();
+  count = std::min(count, n ? n - 1 : 0);
+  neighbours.assign(n * count, 0);
+  if (!count)
+  {
+    return;
+  }
+
+  // about two cities per cell
+  auto minX = cities[0].x, maxX = minX, minY = cities[0].y, maxY = minY;
+  for (auto& city : cities)
+  {
+    minX = std::min(minX, city.x);
+    maxX = std::max(maxX, city.x);
+    minY = std::min(minY, city.y);
+    maxY = std::max(maxY, city.y);
+  }
+  const auto side = std::max<size_t>(static_cast<size_t>(std::sqrt(n / 2.0)), 1);
+  const auto extent = std::max(maxX - minX, maxY - minY);
+  const auto cellSize = extent > 0 ? extent / side : 1.0;
+  const auto cellOf = [&](double value, double min)
+  {
+    return std::min(static_cast<size_t>((value - min) / cellSize), side - 1);
+  };
+
+  // the cities bucketed by cell (a counting sort)
+  std::pmr::vector<size_t> cellStart(side * side + 1, 0, scratch);
+  std::pmr::vector<size_t> cellCities(n, scratch);
+  std::pmr::vector<size_t> cellIndex(n, scratch);
+  for (size_t i = 0; i < n; ++i)
+  {
+    cellIndex[i] = cellOf(cities[i].y, minY) * side + cellOf(cities[i].x, minX);
+    ++cellStart[cellIndex[i] + 1];
+  }
+  for (size_t cell = 0; cell < side * side; ++cell)
+  {
+    cellStart[cell + 1] += cellStart[cell];
+  }
+  {
+    std::pmr::vector<size_t> fill(cellStart.begin(), cellStart.end() - 1, scratch);
+    for (size_t i = 0; i < n; ++i)
+    {
+      cellCities[fill[cellIndex[i]]++] = i;
+    }
+  }
+
+  std::pmr::vector<double> bestDistance(count, scratch);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const auto& city = cities[i];
+    const auto cx = static_cast<long long>(cellIndex[i] % side);
+    const auto cy = static_cast<long long>(cellIndex[i] / side);
+    auto best = &neighbours[i * count];
+    size_t found = 0;
+
+    const auto visit = [&](long long x, long long y)
+    {
+      if (x < 0 || y < 0 || x >= static_cast<long long>(side) || y >= static_cast<long long>(side))
+      {
+        return;
+      }
+
+      const auto cell = static_cast<size_t>(y) * side + static_cast<size_t>(x);
+      for (auto c = cellStart[cell]; c < cellStart[cell + 1]; ++c)
+      {
+        const auto other = cellCities[c];
+        const auto dx = cities[other].x - city.x, dy = cities[other].y - city.y;
+        const auto d = dx * dx + dy * dy;
+        if (other == i || (found == count && d >= bestDistance[count - 1]))
+        {
+          continue;
+        }
+
+        // insertion into the sorted list
+        auto k = found < count ? found++ : count - 1;
+        for (; k > 0 && bestDistance[k - 1] > d; --k)
+        {
+          bestDistance[k] = bestDistance[k - 1];
+          best[k] = best[k - 1];
+        }
+        bestDistance[k] = d;
+        best[k] = other;
+      }
+    };
+
+    // rings of cells around the city's; a city in ring r + 1 is at least r cells away
+    for (long long r = 0; r <= static_cast<long long>(side); ++r)
+    {
+      for (auto x = cx - r; x <= cx + r; ++x)
+      {
+        visit(x, cy - r);
+        if (r)
+        {
+          visit(x, cy + r);
+        }
+      }
+      for (auto y = cy - r + 1; y < cy + r; ++y)
+      {
+        visit(cx - r, y);
+        visit(cx + r, y);
+      }
+
+      const auto reach = static_cast<double>(r) * cellSize;
+      if (found == count && bestDistance[count - 1] <= reach * reach)
+      {
+        break;
+      }
+    }
+  }
+}
+
+void problems::tsp::iteratedLocalSearch(const Cities& cities, TourArray& tour, const IteratedLocalSearchOptions& options, std::pmr::memory_resource* scratch)
+{
+  utility::StoppingCriteria never;
+  iteratedLocalSearch(cities, tour, options, never, scratch);
+}
+
+void problems::tsp::iteratedLocalSearch(const Cities& cities, TourArray& tour, const IteratedLocalSearchOptions& options, utility::StoppingCriteria& stopping,
+                                        std::pmr::memory_resource* scratch)
+{
+  TRACE_ZONE("iteratedLocalSearch");
+
+  const auto n = tour.size();
+  if (n < 4)
+  {
+    return;
+  }
+
+  LocalSearch search(cities, tour, options.neighbours, scratch);
+  search.markAll();
+  const auto descended = search.descend(stopping);
+  stopping.improved(search.length());
+  if (!descended || n < 8)
+  {
+    return;
+  }
+
+  // the segments leave at least one city outside the two of them
+  const auto maxSegment = std::max<size_t>(std::min(options.segmentLength, (n - 2) / 2), 1);
+  std::optional<randomGenerators::BulkRandomEngine> seeded;
+  if (options.seed)
+  {
+    seeded.emplace(*options.seed);
+  }
+  auto& engine = seeded ? *seeded : randomGenerators::DefaultRandomEngine::bulk();
+  auto temperature = options.temperature * search.length() / n;
+
+  // the best tour is only copied when a longer tour is accepted while the current one is the best
+  std::pmr::vector<size_t> best(scratch);
+  auto bestLength = search.length();
+  auto currentIsBest = true;
+
+  for (size_t kick = 0; kick < options.kicks; ++kick)
+  {
+    const auto before = search.length();
+    search.startJournal();
+    search.kick(randomBelow(engine, n), 1 + randomBelow(engine, maxSegment), 1 + randomBelow(engine, maxSegment));
+    const auto stopped = !search.descend(stopping);
+
+    const auto after = search.length();
+    const auto accepted = after <= before + EPSILON || (temperature > 0 && engine.unit() < std::exp((before - after) / temperature));
+    if (!accepted)
+    {
+      search.undo(before);
+    }
+    else if (after < bestLength - EPSILON)
+    {
+      bestLength = after;
+      currentIsBest = true;
+      stopping.improved(bestLength);
+    }
+    else if (after > bestLength + EPSILON && currentIsBest)
+    {
+      // keep the tour before the kick, it was the best
+      search.undo(before);
+      best.assign(tour.begin(), tour.end());
+      search.redo(after);
+      currentIsBest = false;
+    }
+
+    temperature *= options.cooling;
+    if (stopped)
+    {
+      break;
+    }
+  }
+
+  if (!currentIsBest)
+  {
+    std::copy(best.begin(), best.end(), tour.begin());
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef __TSP_ITERATED_LOCAL_SEARCH_H__
+#define __TSP_ITERATED_LOCAL_SEARCH_H__
+
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+
+#include "../../utility/Defines.h"
+#include "../../utility/StoppingCriteria.h"
+#include "Defines.h"
+
+namespace problems {
+  namespace tsp {
+
+    /*! \class IteratedLocalSearchOptions "iteratedLocalSearch.h"
+      * \brief The parameters of the iterated local search.
+      * \ingroup tsp
+      */
+    struct IteratedLocalSearchOptions
+    {
+      size_t kicks = 100000;/*!< the number of double bridge kicks */
+      size_t neighbours = 8;/*!< the candidate list of every city: its nearest neighbours */
+      size_t segmentLength = 50;/*!< the maximum number of cities of a double bridge segment; bounds the cost of a kick */
+      double temperature = 0;/*!< the initial annealing temperature, relative to the mean edge of the tour; 0: only tours at least as short are accepted */
+      double cooling = 0.9999;/*!< the temperature is multiplied by it after every kick */
+      std::optional<uint64_t> seed = std::nullopt;/*!< the seed of the kicks' own engine; the calling thread's bulk engine when empty */
+    };
+
+    /*!
+      * \brief Improves a tour by Iterated Local Search: 2-opt, then double bridge kicks each followed by a localized 2-opt.
+      *
+      * The 2-opt only looks at the edges to the nearest neighbours of a city (candidate lists), and only at the
+      * cities in a queue of dirty cities: the endpoints of the last moves (don't look bits). The first descent
+      * starts with every city dirty; a kick - a double bridge over two short segments (at most segmentLength
+      * cities) - only makes its six endpoints dirty, so a kick and its repair cost about the same on any tour size.
+      * The moves reverse the shorter side of the tour, and are journaled: a rejected kick is undone move by move.
+      *
+      * A kicked tour is accepted when it is not longer, or with the annealing probability exp(-increase / temperature);
+      * the best tour found is returned. The random numbers come from an engine seeded with options.seed, or else
+      * from the calling thread's bulk engine (see randomGenerators::DefaultRandomEngine::bulk).
+      *
+      * \param[in] cities - the cities forming the problem
+      * \param[out] tour - an initial solution (e.g. from nearestNeighbour); the best tour found
+      * \param[in] options - the search parameters
+      * \param[in] scratch - where the working memory comes from (e.g. utility::RunArena::resource())
+      *
+      * \ingroup tsp
+      */
+    void iteratedLocalSearch(const Cities& cities, TourArray& tour, const IteratedLocalSearchOptions& options = IteratedLocalSearchOptions(),
+                             std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+    /*!
+      * \brief Improves a tour by Iterated Local Search, until the kicks are done or stopped.
+      *
+      * Every candidate list scanned counts as an evaluation; the cost is the length of the best tour.
+      *
+      * \param[in] cities - the cities forming the problem
+      * \param[out] tour - an initial solution; the best tour so far when stopped
+      * \param[in] options - the search parameters
+      * \param[in,out] stopping - the stopping criteria
+      * \param[in] scratch - where the working memory comes from (e.g. utility::RunArena::resource())
+      *
+      * \ingroup tsp
+      */
+    void iteratedLocalSearch(const Cities& cities, TourArray& tour, const IteratedLocalSearchOptions& options, utility::StoppingCriteria& stopping,
+                             std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+    /*!
+      * \brief Finds the nearest neighbours of every city, on a uniform grid (about n * count log count for spread cities).
+      *
+      * \param[in] cities - the cities forming the problem
+      * \param[in] count - the number of neighbours of every city (at most cities.size() - 1)
+      * \param[out] neighbours - count neighbours per city, city after city, closest first
+      * \param[in] scratch - where the working memory comes from
+      *
+      * \ingroup tsp
+      */
+    void nearestNeighbourLists(const Cities& cities, size_t count, std::pmr::vector<size_t>& neighbours,
+                               std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+  }
+}
+
+#endif // !__TSP_ITERATED_LOCAL_SEARCH_H__
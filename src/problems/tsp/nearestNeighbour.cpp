@@ -1,8 +1,8 @@
 #include "nearestNeighbour.h"
 
-void problems::tsp::nearestNeighbour(const Cities& cities, size_t startCity, TourArray& tour, double& tourDistance)
+void problems::tsp::nearestNeighbour(const Cities& cities, size_t startCity, TourArray& tour, double& tourDistance, std::pmr::memory_resource* scratch)
 {
-  std::vector<bool> visited(cities.size());
+  std::pmr::vector<bool> visited(cities.size(), false, scratch);
   visited[startCity] = true;
   tourDistance = 0;
 
@@ -1,6 +1,8 @@
 #ifndef __TSP_NEAREST_NEIGHBOUR_H__
 #define __TSP_NEAREST_NEIGHBOUR_H__
 
+#include <memory_resource>
+
 #include "../../utility/Defines.h"
 #include "Defines.h"
 
@@ -14,10 +16,12 @@ namespace problems {
       * \param[in] startCity - the index of the first city
       * \param[out] tour - the computed tour
       * \param[out] tourDistance - the tour distance
+      * \param[in] scratch - where the working memory comes from (e.g. utility::RunArena::resource())
       *
       * \ingroup tsp
       */
-    void nearestNeighbour(const Cities& cities, size_t startCity, TourArray& tour, double& tourDistance);   
+    void nearestNeighbour(const Cities& cities, size_t startCity, TourArray& tour, double& tourDistance,
+                          std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
   }
 }
 
@@ -1,3 +1,4 @@
+#include "../../statistics/trace.h"
 #include "twoOpt.h"
 
 void problems::tsp::reverseSegment(TourArray& tour, size_t startIndex, size_t endIndex)
@@ -20,6 +21,15 @@ void problems::tsp::reverseSegment(TourArray& tour, size_t startIndex, size_t en
 
 void problems::tsp::firstTwoOptMove(const Cities& cities, TourArray& tour)
 {
+  utility::StoppingCriteria never;
+  firstTwoOptMove(cities, tour, never);
+}
+
+void problems::tsp::firstTwoOptMove(const Cities& cities, TourArray& tour, utility::StoppingCriteria& stopping)
+{
+  // the cost reported to the stopping criteria
+  auto length = tourLength(cities, tour);
+
   // we'll get munching at it until no more local optima is available
   auto locallyOptimal = false;
 
@@ -34,28 +44,51 @@ void problems::tsp::firstTwoOptMove(const Cities& cities, TourArray& tour)
       const auto& x1 = cities[tour[static_cast<size_t>(i) + 1]];
 
       const auto l = (i == 0) ? s - 1 : s;
-      for (auto j = i + 2; j < l; ++j)
+      auto j = i + 2;
+      for (; j < l; ++j)
       {
         const auto& y0 = cities[tour[j]];
         const auto& y1 = cities[tour[(static_cast<size_t>(j) + 1) % s]];
 
-        if (twoOptGain(x0, x1, y0, y1) > 0)
+        const auto gain = twoOptGain(x0, x1, y0, y1);
+        if (gain > 0)
         {
           makeTwoOptMove(tour, i, j);
+          length -= gain;
+          stopping.improved(length);
           locallyOptimal = false;
+          ++j;
           break;
         }
       }
+
+      // the gains computed by this row
+      if (stopping.evaluated(static_cast<size_t>(j - i - 2)))
+      {
+        return;
+      }
     }      
   }
 }
 
 void problems::tsp::twoOptMove(const Cities& cities, TourArray& tour)
 {
+  utility::StoppingCriteria never;
+  twoOptMove(cities, tour, never);
+}
+
+void problems::tsp::twoOptMove(const Cities& cities, TourArray& tour, utility::StoppingCriteria& stopping)
+{
+  TRACE_ZONE("twoOptMove");
+
+  // the cost reported to the stopping criteria
+  auto length = tourLength(cities, tour);
+
   // we'll got munching at it until no more local optima is available
   auto locallyOptimal = false;
+  auto stopped = false;
 
-  while (!locallyOptimal)
+  while (!locallyOptimal && !stopped)
   {
     locallyOptimal = true;
 
@@ -72,28 +105,41 @@ void problems::tsp::twoOptMove(const Cities& cities, TourArray& tour)
       }
     }bestGain;
 
-    const auto s = tour.size();
-    for (auto i = 0; i < s - 1/* leave enough room for j */; ++i)
+    // its own scope, so the zone ends before the segment reversal
     {
-      const auto& x0 = cities[tour[i]];
-      const auto& x1 = cities[tour[static_cast<size_t>(i) + 1]];
-
-      const auto l = (i == 0) ? s - 1 : s;
-      for (auto j = i + 2; j < l; ++j)
+      TRACE_ZONE("twoOptMove/gainScan");
+      const auto s = tour.size();
+      for (auto i = 0; i < s - 1 && !stopped/* leave enough room for j */; ++i)
       {
-        const auto& y0 = cities[tour[j]];
-        const auto& y1 = cities[tour[(static_cast<size_t>(j) + 1) % s]];
+        const auto& x0 = cities[tour[i]];
+        const auto& x1 = cities[tour[static_cast<size_t>(i) + 1]];
 
-        if (double gain = twoOptGain(x0, x1, y0, y1) > bestGain.gain)
+        const auto l = (i == 0) ? s - 1 : s;
+        auto j = i + 2;
+        for (; j < l; ++j)
         {
-          bestGain.set(i, j, gain);          
-          locallyOptimal = false;          
+          const auto& y0 = cities[tour[j]];
+          const auto& y1 = cities[tour[(static_cast<size_t>(j) + 1) % s]];
+
+          const auto gain = twoOptGain(x0, x1, y0, y1);
+          if (gain > bestGain.gain)
+          {
+            bestGain.set(i, j, gain);          
+            locallyOptimal = false;          
+          }
         }
+
+        // the gains computed by this row
+        stopped = stopping.evaluated(static_cast<size_t>(j - i - 2));
       }
     }
     if (!locallyOptimal)
     {
+      // an interrupted scan still applies its best move - the tour only gets better
+      TRACE_ZONE("twoOptMove/reverseSegment");
       makeTwoOptMove(tour, bestGain.i, bestGain.j);
+      length -= bestGain.gain;
+      stopping.improved(length);
     }
   }
 }
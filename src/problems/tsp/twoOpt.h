@@ -2,6 +2,7 @@
 #define __TSP_TWO_OPT_H__
 
 #include "../../utility/Defines.h"
+#include "../../utility/StoppingCriteria.h"
 #include "Defines.h"
 
 namespace problems {
@@ -62,6 +63,19 @@ namespace problems {
       * \ingroup tsp
       */
     void firstTwoOptMove(const Cities& cities, TourArray& tour);
+
+    /*!
+      * \brief Executes an optimization of the tour using the first Opt Move that provides gain, until it is locally optimal or stopped.
+      *
+      * Every gain computed counts as an evaluation (checked once per scanned city); the cost is the tour length.
+      *
+      * \param[in] cities - the cities forming the problem
+      * \param[out] tour - an initial solution; the best tour so far when stopped
+      * \param[in,out] stopping - the stopping criteria
+      *
+      * \ingroup tsp
+      */
+    void firstTwoOptMove(const Cities& cities, TourArray& tour, utility::StoppingCriteria& stopping);
     
     /*!
       * \brief Executes an optimization of the tour using the Opt Move that provides the best gain.
@@ -72,6 +86,20 @@ namespace problems {
       * \ingroup tsp
       */
     void twoOptMove(const Cities& cities, TourArray& tour);
+
+    /*!
+      * \brief Executes an optimization of the tour using the Opt Move that provides the best gain, until it is locally optimal or stopped.
+      *
+      * Every gain computed counts as an evaluation (checked once per scanned city); the cost is the tour length.
+      * A scan interrupted by the stopping criteria still applies the best move it found.
+      *
+      * \param[in] cities - the cities forming the problem
+      * \param[out] tour - an initial solution; the best tour so far when stopped
+      * \param[in,out] stopping - the stopping criteria
+      *
+      * \ingroup tsp
+      */
+    void twoOptMove(const Cities& cities, TourArray& tour, utility::StoppingCriteria& stopping);
   }
 }
 
@@ -0,0 +1,317 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: bulk random number generation - several independent xoshiro256+ lanes filling whole buffers
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __BULK_GENERATOR_H__
+#define __BULK_GENERATOR_H__
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "../utility/Defines.h"
+
+namespace randomGenerators
+{
+  /*! \class BulkRandomEngine "bulkGenerator.h"
+    * \brief Fills whole buffers with random numbers, LANES numbers per step.
+    *
+    * The engine runs LANES independent xoshiro256+ generators side by side; their states are kept
+    * lane-interleaved (structure of arrays), so one step of all the lanes is a handful of AVX2
+    * instructions (or a loop the compiler can vectorize). The 64 bit outputs are turned into
+    * floating point numbers by bit twiddling rather than by a division: the top mantissa bits are
+    * or-ed with the exponent of 1.0, giving a number in [1, 2), from which 1 is subtracted.
+    * Integers in a range use Lemire's multiply-shift (with rejection, so there is no bias).
+    *
+    * xoshiro256+ has weak lowest bits; only the upper bits of every output are used.
+    *
+    * The AVX2 and the scalar paths give the same numbers: both scale with a multiply and an add.
+    * A compiler allowed to contract them into FMAs (GCC's default once FMA is enabled; use
+    * -ffp-contract=off) rounds some numbers differently.
+    *
+    * It is also a UniformRandomBitGenerator, so the std distributions (and the slow paths of the
+    * non-uniform generators, see distributions.h) can draw single words from it.
+    * \ingroup randomGenerators
+    */
+  class BulkRandomEngine
+  {
+  public:
+    static constexpr size_t LANES = 4;/*!< the independent generators, one 256 bit register */
+
+    using result_type = uint64_t;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    /*!
+      * \brief init c-tor
+      * \param seed - the seed; every lane and state word is derived from it
+      */
+    explicit BulkRandomEngine(uint64_t seed = 0)
+    {
+      this->seed(seed);
+    }
+
+    /*!
+      * \brief Restarts the engine
+      * \param value - the seed; the same seed always yields the same numbers
+      */
+    void seed(uint64_t value)
+    {
+      FOR(lane, LANES)
+      {
+        FOR(word, 4)
+        {
+          // splitmix64 of the seed, as recommended for the xoshiro family: never an all zero state
+          auto z = value + (static_cast<uint64_t>(lane) * 4 + word + 1) * 0x9E3779B97F4A7C15ull;
+          z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+          z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+          _state[word][lane] = z ^ (z >> 31);
+        }
+      }
+
+      _buffered = 0;
+    }
+
+    /*!
+      * \brief Draws a single random word
+      *
+      * The words come from a step of all the lanes, buffered; prefer the bulk fills for many numbers.
+      * \return the random word
+      */
+    result_type operator()()
+    {
+      if (!_buffered)
+      {
+        next(_buffer);
+        _buffered = LANES;
+      }
+
+      return _buffer[--_buffered];
+    }
+
+    /*!
+      * \brief Draws a single uniform distributed number in [0, 1)
+      * \return the random number
+      */
+    double unit()
+    {
+      return static_cast<double>((*this)() >> 11) * 0x1.0p-53;
+    }
+
+    /*!
+      * \brief Fills the buffer with uniform distributed floating point numbers in [min, max)
+      * \tparam Type - float or double
+      *
+      * \param out - the buffer to fill
+      * \param min - the smallest number possible
+      * \param max - the upper bound
+      */
+    template <typename Type>
+      requires std::is_same_v<Type, double> || std::is_same_v<Type, float>
+    void fillUniform(std::span<Type> out, Type min, Type max)
+    {
+      const auto range = max - min;
+      constexpr auto perStep = LANES * sizeof(uint64_t) / sizeof(Type);
+
+      auto data = out.data();
+      const auto blocks = out.size() / perStep;
+
+#if defined(__AVX2__)
+      auto s0 = load(0), s1 = load(1), s2 = load(2), s3 = load(3);
+      for (size_t block = 0; block < blocks; ++block, data += perStep)
+      {
+        const auto bits = next(s0, s1, s2, s3);
+        if constexpr (std::is_same_v<Type, double>)
+        {
+          // 52 mantissa bits from the top of every lane: [1, 2) - 1 -> [0, 1)
+          const auto one = _mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 12), _mm256_set1_epi64x(0x3FF0000000000000ll)));
+          const auto unit = _mm256_sub_pd(one, _mm256_set1_pd(1.0));
+          _mm256_storeu_pd(data, _mm256_add_pd(_mm256_set1_pd(min), _mm256_mul_pd(unit, _mm256_set1_pd(range))));
+        }
+        else
+        {
+          // every 64 bit lane gives two floats: 23 mantissa bits from the top of each half
+          const auto one = _mm256_castsi256_ps(_mm256_or_si256(_mm256_srli_epi32(bits, 9), _mm256_set1_epi32(0x3F800000)));
+          const auto unit = _mm256_sub_ps(one, _mm256_set1_ps(1.0f));
+          _mm256_storeu_ps(data, _mm256_add_ps(_mm256_set1_ps(min), _mm256_mul_ps(unit, _mm256_set1_ps(range))));
+        }
+      }
+      store(s0, s1, s2, s3);
+#else
+      for (size_t block = 0; block < blocks; ++block, data += perStep)
+      {
+        uint64_t bits[LANES];
+        next(bits);
+        toUniform(bits, data, perStep, min, range);
+      }
+#endif
+
+      // the tail: one more step, part of it thrown away
+      if (const auto rest = out.size() - blocks * perStep)
+      {
+        uint64_t bits[LANES];
+        next(bits);
+        toUniform(bits, data, rest, min, range);
+      }
+    }
+
+    /*!
+      * \brief Fills the buffer with uniform distributed integers in [min, max]
+      *
+      * The range must fit 32 bits (any short or int range does); each 64 bit output gives the
+      * upper 32 bits to Lemire's multiply-shift.
+      * \tparam Type - an integer type
+      *
+      * \param out - the buffer to fill
+      * \param min - the smallest number possible
+      * \param max - the largest number possible
+      */
+    template <typename Type>
+      requires std::is_integral_v<Type>
+    void fillUniform(std::span<Type> out, Type min, Type max)
+    {
+      const auto range = static_cast<uint64_t>(static_cast<int64_t>(max) - static_cast<int64_t>(min)) + 1;
+      // range - 2^32 % range: the low products below it would make some numbers more likely
+      const auto threshold = static_cast<uint32_t>((uint64_t(1) << 32) % range);
+
+      uint64_t bits[LANES];
+      size_t used = LANES;
+      for (auto& value : out)
+      {
+        for (;;)
+        {
+          if (used == LANES)
+          {
+            next(bits);
+            used = 0;
+          }
+
+          const auto product = (bits[used++] >> 32) * range;
+          if (static_cast<uint32_t>(product) >= threshold)
+          {
+            value = static_cast<Type>(static_cast<int64_t>(min) + static_cast<int64_t>(product >> 32));
+            break;
+          }
+        }
+      }
+    }
+
+    /*!
+      * \brief Fills the buffer with raw 64 bit random words
+      * \param out - the buffer to fill
+      */
+    void fill(std::span<uint64_t> out)
+    {
+      auto data = out.data();
+      const auto blocks = out.size() / LANES;
+      for (size_t block = 0; block < blocks; ++block, data += LANES)
+      {
+        next(data);
+      }
+
+      if (const auto rest = out.size() - blocks * LANES)
+      {
+        uint64_t bits[LANES];
+        next(bits);
+        std::copy_n(bits, rest, data);
+      }
+    }
+
+  protected:
+
+    //! one step of all the lanes
+    void next(uint64_t* out)
+    {
+      FOR(lane, LANES)
+      {
+        auto& s0 = _state[0][lane];
+        auto& s1 = _state[1][lane];
+        auto& s2 = _state[2][lane];
+        auto& s3 = _state[3][lane];
+
+        out[lane] = s0 + s3;
+
+        const auto t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = std::rotl(s3, 45);
+      }
+    }
+
+    //! converts random words to numbers in [min, min + range), count numbers at most
+    template <typename Type>
+    static void toUniform(const uint64_t* bits, Type* out, size_t count, Type min, Type range)
+    {
+      if constexpr (std::is_same_v<Type, double>)
+      {
+        FOR(i, count)
+        {
+          const auto one = std::bit_cast<double>((bits[i] >> 12) | 0x3FF0000000000000ull);
+          out[i] = min + (one - 1.0) * range;
+        }
+      }
+      else
+      {
+        uint32_t halves[LANES * 2];
+        std::memcpy(halves, bits, sizeof(halves));
+        FOR(i, count)
+        {
+          const auto one = std::bit_cast<float>((halves[i] >> 9) | 0x3F800000u);
+          out[i] = min + (one - 1.0f) * range;
+        }
+      }
+    }
+
+#if defined(__AVX2__)
+    __m256i load(size_t word) const
+    {
+      return _mm256_load_si256(reinterpret_cast<const __m256i*>(_state[word]));
+    }
+
+    void store(__m256i s0, __m256i s1, __m256i s2, __m256i s3)
+    {
+      _mm256_store_si256(reinterpret_cast<__m256i*>(_state[0]), s0);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(_state[1]), s1);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(_state[2]), s2);
+      _mm256_store_si256(reinterpret_cast<__m256i*>(_state[3]), s3);
+    }
+
+    //! one step of all the lanes, the state kept in registers
+    static __m256i next(__m256i& s0, __m256i& s1, __m256i& s2, __m256i& s3)
+    {
+      const auto result = _mm256_add_epi64(s0, s3);
+
+      const auto t = _mm256_slli_epi64(s1, 17);
+      s2 = _mm256_xor_si256(s2, s0);
+      s3 = _mm256_xor_si256(s3, s1);
+      s1 = _mm256_xor_si256(s1, s2);
+      s0 = _mm256_xor_si256(s0, s3);
+      s2 = _mm256_xor_si256(s2, t);
+      s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+
+      return result;
+    }
+#endif
+
+    alignas(32) uint64_t _state[4][LANES];/*!< _state[word][lane] - the xoshiro256 state words, lane-interleaved */
+    uint64_t _buffer[LANES];/*!< the words not yet handed out by operator() */
+    size_t _buffered = 0;/*!< the number of words left in _buffer */
+  };
+}
+
+#endif // !__BULK_GENERATOR_H__
@@ -0,0 +1,423 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: fast non-uniform random numbers - Gaussian (Ziggurat), Cauchy and Levy-stable (Mantegna)
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __DISTRIBUTIONS_H__
+#define __DISTRIBUTIONS_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <span>
+
+#include "../utility/Defines.h"
+#include "bulkGenerator.h"
+
+namespace randomGenerators
+{
+  //! the stability index used for Levy flights when none is given
+  static constexpr double LEVY_ALPHA = 1.5;
+
+  /*! \class ZigguratTables "distributions.h"
+    * \brief The 128 layer Ziggurat of the standard normal density (Marsaglia & Tsang, 2000).
+    *
+    * A sample picks a layer and a signed 32 bit integer hz; when |hz| < k[layer] (about 99% of the
+    * time) hz * w[layer] is already the normal number, without calling exp or log.
+    * \ingroup randomGenerators
+    */
+  struct ZigguratTables
+  {
+    static constexpr size_t LAYERS = 128;
+    static constexpr double R = 3.442619855899;/*!< the start of the tail */
+    static constexpr double AREA = 9.91256303526217e-3;/*!< the area of every layer */
+
+    uint32_t k[LAYERS];/*!< the acceptance bounds of the layers */
+    double w[LAYERS];/*!< hz to x */
+    double f[LAYERS];/*!< the density at the layer edges */
+
+    ZigguratTables()
+    {
+      constexpr double m = 2147483648.0;
+      auto d = R, t = R;
+      const auto q = AREA / std::exp(-0.5 * d * d);
+
+      k[0] = static_cast<uint32_t>((d / q) * m);
+      k[1] = 0;
+      w[0] = q / m;
+      w[LAYERS - 1] = d / m;
+      f[0] = 1.0;
+      f[LAYERS - 1] = std::exp(-0.5 * d * d);
+
+      for (auto i = LAYERS - 2; i >= 1; --i)
+      {
+        d = std::sqrt(-2.0 * std::log(AREA / d + std::exp(-0.5 * d * d)));
+        k[i + 1] = static_cast<uint32_t>((d / t) * m);
+        t = d;
+        f[i] = std::exp(-0.5 * d * d);
+        w[i] = d / m;
+      }
+    }
+
+    //! the tables, built once
+    static const ZigguratTables& get()
+    {
+      static const ZigguratTables s_tables;
+      return s_tables;
+    }
+  };
+
+
+  /*!
+    * \brief A standard normal number from the Ziggurat, starting with the given word.
+    * \param engine - the engine to draw more words from
+    * \param word - the first random word (e.g. one rejected by the fast path of fillGaussian)
+    *
+    * \return a standard normal number
+    * \ingroup randomGenerators
+    */
+  inline double standardGaussian(BulkRandomEngine& engine, uint64_t word)
+  {
+    const auto& z = ZigguratTables::get();
+    for (;;)
+    {
+      // hz from the upper half, the layer from bits 8..14: independent bits, and none of the weak low ones
+      const auto hz = static_cast<int32_t>(word >> 32);
+      const auto layer = static_cast<size_t>((word >> 8) & (ZigguratTables::LAYERS - 1));
+      const auto x = hz * z.w[layer];
+
+      if (static_cast<uint32_t>(std::abs(static_cast<int64_t>(hz))) < z.k[layer])
+      {
+        return x;
+      }
+
+      if (!layer)
+      {
+        // the tail beyond R (Marsaglia's exponential method)
+        double tx, ty;
+        do
+        {
+          tx = -std::log(1.0 - engine.unit()) / ZigguratTables::R;
+          ty = -std::log(1.0 - engine.unit());
+        } while (ty + ty < tx * tx);
+
+        return hz > 0 ? ZigguratTables::R + tx : -ZigguratTables::R - tx;
+      }
+
+      if (z.f[layer] + engine.unit() * (z.f[layer - 1] - z.f[layer]) < std::exp(-0.5 * x * x))
+      {
+        return x;
+      }
+
+      word = engine();
+    }
+  }
+
+
+  /*!
+    * \brief Fills the buffer with normal distributed numbers
+    *
+    * The words are generated in bulk and converted in a branch free pass (a table lookup and a
+    * multiplication per number); the ~1% rejected ones (the tail and the wedges) are redone by standardGaussian.
+    * \tparam Type - float or double
+    *
+    * \param engine - the engine
+    * \param out - the buffer to fill
+    * \param mean - the mean
+    * \param sigma - the standard deviation
+    * \ingroup randomGenerators
+    */
+  template <typename Type>
+  void fillGaussian(BulkRandomEngine& engine, std::span<Type> out, Type mean, Type sigma)
+  {
+    constexpr size_t CHUNK = 256;
+    const auto& z = ZigguratTables::get();
+
+    uint64_t words[CHUNK];
+    for (size_t begin = 0; begin < out.size(); begin += CHUNK)
+    {
+      const auto count = std::min(CHUNK, out.size() - begin);
+      engine.fill(std::span<uint64_t>(words, count));
+
+      auto rejected = false;
+      FOR(i, count)
+      {
+        const auto hz = static_cast<int32_t>(words[i] >> 32);
+        const auto layer = static_cast<size_t>((words[i] >> 8) & (ZigguratTables::LAYERS - 1));
+        out[begin + i] = static_cast<Type>(mean + sigma * (hz * z.w[layer]));
+        rejected |= static_cast<uint32_t>(std::abs(static_cast<int64_t>(hz))) >= z.k[layer];
+      }
+
+      if (rejected)
+      {
+        FOR(i, count)
+        {
+          const auto hz = static_cast<int32_t>(words[i] >> 32);
+          const auto layer = static_cast<size_t>((words[i] >> 8) & (ZigguratTables::LAYERS - 1));
+          if (static_cast<uint32_t>(std::abs(static_cast<int64_t>(hz))) >= z.k[layer])
+          {
+            out[begin + i] = static_cast<Type>(mean + sigma * standardGaussian(engine, words[i]));
+          }
+        }
+      }
+    }
+  }
+
+
+  /*!
+    * \brief Fills the buffer with Cauchy distributed numbers (location + scale * tan(pi * (u - 1/2)))
+    * \tparam Type - float or double
+    *
+    * \param engine - the engine
+    * \param out - the buffer to fill
+    * \param location - the median
+    * \param scale - the half width at half maximum
+    * \ingroup randomGenerators
+    */
+  template <typename Type>
+  void fillCauchy(BulkRandomEngine& engine, std::span<Type> out, Type location, Type scale)
+  {
+    engine.fillUniform<Type>(out, static_cast<Type>(-0.5), static_cast<Type>(0.5));
+    for (auto& value : out)
+    {
+      value = location + scale * std::tan(std::numbers::pi_v<Type> * value);
+    }
+  }
+
+
+  /*!
+    * \brief The scale of the numerator of Mantegna's algorithm
+    * \param alpha - the stability index, in (0, 2]
+    *
+    * \return sigma_u
+    * \ingroup randomGenerators
+    */
+  inline double mantegnaSigma(double alpha)
+  {
+    const auto numerator = std::tgamma(1 + alpha) * std::sin(std::numbers::pi * alpha / 2);
+    const auto denominator = std::tgamma((1 + alpha) / 2) * alpha * std::pow(2.0, (alpha - 1) / 2);
+    return std::pow(numerator / denominator, 1 / alpha);
+  }
+
+
+  /*!
+    * \brief Fills the buffer with symmetric Levy-stable distributed numbers (Mantegna's algorithm)
+    *
+    * u / |v|^(1 / alpha) with u ~ N(0, sigma_u^2) and v ~ N(0, 1): mostly small numbers with
+    * occasional very large ones, the step lengths of a Levy flight.
+    * \tparam Type - float or double
+    *
+    * \param engine - the engine
+    * \param out - the buffer to fill
+    * \param alpha - the stability index, in (0, 2]; smaller means heavier tails
+    * \param scale - the scale of the numbers
+    * \ingroup randomGenerators
+    */
+  template <typename Type>
+  void fillLevy(BulkRandomEngine& engine, std::span<Type> out, Type alpha, Type scale)
+  {
+    constexpr size_t CHUNK = 256;
+    const auto sigma = static_cast<Type>(mantegnaSigma(alpha));
+    const auto exponent = -1 / alpha;
+
+    Type denominators[CHUNK];
+    for (size_t begin = 0; begin < out.size(); begin += CHUNK)
+    {
+      const auto count = std::min(CHUNK, out.size() - begin);
+      const auto numerators = out.subspan(begin, count);
+      fillGaussian<Type>(engine, numerators, 0, sigma);
+      fillGaussian<Type>(engine, std::span<Type>(denominators, count), 0, 1);
+
+      FOR(i, count)
+      {
+        const auto v = std::max(std::abs(denominators[i]), std::numeric_limits<Type>::min());
+        numerators[i] *= scale * std::pow(v, exponent);
+      }
+    }
+  }
+
+
+  /*!
+    * \brief Redraws the numbers outside [min, max] until all of them are inside (a truncated distribution)
+    * \tparam Type - the number type
+    * \tparam FillFunction - void(std::span<Type>), fills with the untruncated distribution
+    *
+    * \param out - the buffer
+    * \param min - the smallest number allowed
+    * \param max - the largest number allowed
+    * \param fill - the untruncated fill
+    * \ingroup randomGenerators
+    */
+  template <typename Type, class FillFunction>
+  void truncate(std::span<Type> out, Type min, Type max, FillFunction fill)
+  {
+    constexpr size_t CHUNK = 64;
+    Type redraw[CHUNK];
+    size_t used = CHUNK;
+    for (auto& value : out)
+    {
+      while (value < min || value > max)
+      {
+        if (used == CHUNK)
+        {
+          fill(std::span<Type>(redraw, CHUNK));
+          used = 0;
+        }
+        value = redraw[used++];
+      }
+    }
+  }
+
+
+  /*! \class GaussianDistributedGenerator "distributions.h"
+    * \brief The normal distributed numbers generator.
+    * \tparam Type - float or double
+    * \ingroup randomGenerators
+    */
+  template <typename Type>
+  class GaussianDistributedGenerator
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param mean - the mean
+      * \param sigma - the standard deviation
+      */
+    GaussianDistributedGenerator(Type mean, Type sigma) :
+      _mean(mean)
+    , _sigma(sigma)
+    {
+      ;
+    }
+
+    /*!
+      * \brief gets a random number
+      * \param engine - the engine to use
+      *
+      * \return a random number with the given distribution
+      */
+    Type operator()(BulkRandomEngine& engine)
+    {
+      return static_cast<Type>(_mean + _sigma * standardGaussian(engine, engine()));
+    }
+
+    /*!
+      * \brief fills a buffer
+      * \param engine - the engine to use
+      * \param out - the buffer to fill
+      */
+    void fill(BulkRandomEngine& engine, std::span<Type> out)
+    {
+      fillGaussian<Type>(engine, out, _mean, _sigma);
+    }
+
+  protected:
+    Type _mean;/*!< the mean */
+    Type _sigma;/*!< the standard deviation */
+  };
+
+
+  /*! \class CauchyDistributedGenerator "distributions.h"
+    * \brief The Cauchy distributed numbers generator.
+    * \tparam Type - float or double
+    * \ingroup randomGenerators
+    */
+  template <typename Type>
+  class CauchyDistributedGenerator
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param location - the median
+      * \param scale - the half width at half maximum
+      */
+    CauchyDistributedGenerator(Type location, Type scale) :
+      _location(location)
+    , _scale(scale)
+    {
+      ;
+    }
+
+    /*!
+      * \brief gets a random number
+      * \param engine - the engine to use
+      *
+      * \return a random number with the given distribution
+      */
+    Type operator()(BulkRandomEngine& engine)
+    {
+      return static_cast<Type>(_location + _scale * std::tan(std::numbers::pi * (engine.unit() - 0.5)));
+    }
+
+    /*!
+      * \brief fills a buffer
+      * \param engine - the engine to use
+      * \param out - the buffer to fill
+      */
+    void fill(BulkRandomEngine& engine, std::span<Type> out)
+    {
+      fillCauchy<Type>(engine, out, _location, _scale);
+    }
+
+  protected:
+    Type _location;/*!< the median */
+    Type _scale;/*!< the half width at half maximum */
+  };
+
+
+  /*! \class LevyDistributedGenerator "distributions.h"
+    * \brief The symmetric Levy-stable distributed numbers generator (Mantegna's algorithm).
+    * \tparam Type - float or double
+    * \ingroup randomGenerators
+    */
+  template <typename Type>
+  class LevyDistributedGenerator
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param alpha - the stability index, in (0, 2]
+      * \param scale - the scale of the numbers
+      */
+    LevyDistributedGenerator(Type alpha, Type scale) :
+      _alpha(alpha)
+    , _scale(scale)
+    , _sigma(static_cast<Type>(mantegnaSigma(alpha)))
+    {
+      ;
+    }
+
+    /*!
+      * \brief gets a random number
+      * \param engine - the engine to use
+      *
+      * \return a random number with the given distribution
+      */
+    Type operator()(BulkRandomEngine& engine)
+    {
+      const auto u = _sigma * standardGaussian(engine, engine());
+      const auto v = std::max(std::abs(standardGaussian(engine, engine())), std::numeric_limits<double>::min());
+      return static_cast<Type>(_scale * u * std::pow(v, -1.0 / _alpha));
+    }
+
+    /*!
+      * \brief fills a buffer
+      * \param engine - the engine to use
+      * \param out - the buffer to fill
+      */
+    void fill(BulkRandomEngine& engine, std::span<Type> out)
+    {
+      fillLevy<Type>(engine, out, _alpha, _scale);
+    }
+
+  protected:
+    Type _alpha;/*!< the stability index */
+    Type _scale;/*!< the scale */
+    Type _sigma;/*!< Mantegna's sigma_u */
+  };
+}
+
+#endif // !__DISTRIBUTIONS_H__
@@ -0,0 +1,447 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: low discrepancy (quasi random) sequences - Sobol and scrambled Halton
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __QUASI_RANDOM_H__
+#define __QUASI_RANDOM_H__
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "bulkGenerator.h"
+
+namespace randomGenerators
+{
+  /*!
+    * \brief Tells whether a polynomial over GF(2) is primitive (x generates the multiplicative group modulo it).
+    * \param polynomial - the coefficients, bit i for x^i; the degree is the highest set bit (at most 32)
+    *
+    * \return true for a primitive polynomial
+    * \ingroup randomGenerators
+    */
+  inline bool isPrimitivePolynomial(uint64_t polynomial)
+  {
+    const auto degree = static_cast<int>(std::bit_width(polynomial)) - 1;
+    if (degree < 1 || !(polynomial & 1))
+    {
+      return false;
+    }
+
+    // x^power modulo the polynomial
+    const auto power = [&](uint64_t exponent)
+    {
+      const auto multiply = [&](uint64_t a, uint64_t b)
+      {
+        uint64_t product = 0;
+        for (; b; b >>= 1)
+        {
+          if (b & 1)
+          {
+            product ^= a;
+          }
+          a <<= 1;
+          if (a >> degree & 1)
+          {
+            a ^= polynomial;
+          }
+        }
+        return product;
+      };
+
+      uint64_t result = 1, base = degree > 1 ? 2 : (2 ^ polynomial);
+      for (; exponent; exponent >>= 1)
+      {
+        if (exponent & 1)
+        {
+          result = multiply(result, base);
+        }
+        base = multiply(base, base);
+      }
+      return result;
+    };
+
+    // the order of x must be exactly 2^degree - 1: x^order = 1 and x^(order / q) != 1 for every prime q | order
+    const auto order = (uint64_t(1) << degree) - 1;
+    if (power(order) != 1)
+    {
+      return false;
+    }
+
+    auto rest = order;
+    for (uint64_t q = 2; q * q <= rest; ++q)
+    {
+      if (rest % q == 0)
+      {
+        if (power(order / q) == 1)
+        {
+          return false;
+        }
+        while (rest % q == 0)
+        {
+          rest /= q;
+        }
+      }
+    }
+
+    // what is left after the trial divisions is a prime factor too
+    return rest == 1 || power(order / rest) != 1;
+  }
+
+
+  /*! \class SobolSequence "quasiRandom.h"
+    * \brief The Sobol low discrepancy sequence in [0, 1)^dimensions.
+    *
+    * The first 21 dimensions use the Joe & Kuo (2008) direction numbers; further dimensions use the
+    * next primitive polynomials (by degree) with deterministic odd initial direction numbers, which
+    * keeps the sequence well defined for any problem size (with weaker 2D projections).
+    * Consecutive points are generated in Gray code order: a single XOR per coordinate. Up to CAPACITY points.
+    * \ingroup randomGenerators
+    */
+  class SobolSequence
+  {
+  public:
+    static constexpr int BITS = 32;/*!< the precision of the coordinates */
+    static constexpr uint64_t CAPACITY = uint64_t(1) << BITS;/*!< the number of distinct points */
+
+    /*!
+      * \brief init c-tor
+      * \param dimensions - the dimension of the points
+      * \param scrambleSeed - the seed of a random digital shift of every coordinate (randomized QMC:
+      *                       independent repetitions); 0 keeps the plain sequence
+      */
+    explicit SobolSequence(size_t dimensions, uint64_t scrambleSeed = 0) :
+      _directions(dimensions * BITS)
+    , _shift(dimensions, 0)
+    , _state(dimensions, 0)
+    , _index(0)
+    {
+      initializeDirections();
+
+      if (scrambleSeed)
+      {
+        BulkRandomEngine engine(scrambleSeed);
+        for (auto& shift : _shift)
+        {
+          shift = static_cast<uint32_t>(engine() >> 32);
+        }
+      }
+      _state = _shift;
+    }
+
+    //! the dimension of the points
+    size_t dimensions() const { return _shift.size(); }
+
+    //! the index of the next point
+    uint64_t index() const { return _index; }
+
+    //! all the CAPACITY points were generated
+    bool exhausted() const { return _index >= CAPACITY; }
+
+    /*!
+      * \brief Jumps to the given point in O(dimensions x BITS), e.g. to split the sequence across threads
+      * \param index - the index of the next point; below CAPACITY
+      */
+    void skipTo(uint64_t index)
+    {
+      assert(index < CAPACITY);
+      const auto gray = index ^ (index >> 1);
+      FOR(d, dimensions())
+      {
+        auto x = _shift[d];
+        FOR(bit, BITS)
+        {
+          if (gray >> bit & 1)
+          {
+            x ^= _directions[d * BITS + bit];
+          }
+        }
+        _state[d] = x;
+      }
+      _index = index;
+    }
+
+    /*!
+      * \brief Writes the next point, then advances the sequence in O(dimensions)
+      * \tparam Type - float or double
+      * \param out - the point; must have dimensions() coordinates
+      *
+      * \return false, leaving out alone, once the sequence is exhausted
+      */
+    template <typename Type>
+    bool next(std::span<Type> out)
+    {
+      if (exhausted())
+      {
+        return false;
+      }
+
+      constexpr auto scale = static_cast<Type>(1.0 / 4294967296.0);
+      for (size_t d = 0; d < dimensions(); ++d)
+      {
+        out[d] = static_cast<Type>(_state[d]) * scale;
+      }
+
+      // the points n and n + 1 differ (in Gray code order) by the direction of n's lowest zero bit;
+      // the last point (all ones) has no successor
+      const auto bit = std::countr_one(_index);
+      if (bit < BITS)
+      {
+        for (size_t d = 0; d < dimensions(); ++d)
+        {
+          _state[d] ^= _directions[d * BITS + bit];
+        }
+      }
+      ++_index;
+      return true;
+    }
+
+  protected:
+    struct Polynomial
+    {
+      uint32_t degree;/*!< s */
+      uint32_t coefficients;/*!< a: the inner coefficients, highest first */
+      uint32_t initial[BITS];/*!< m_1 .. m_s */
+    };
+
+    void initializeDirections()
+    {
+      static constexpr Polynomial JOE_KUO[] = {
+        { 1, 0, { 1 } }, { 2, 1, { 1, 3 } }, { 3, 1, { 1, 3, 1 } }, { 3, 2, { 1, 1, 1 } },
+        { 4, 1, { 1, 1, 3, 3 } }, { 4, 4, { 1, 3, 5, 13 } }, { 5, 2, { 1, 1, 5, 5, 17 } },
+        { 5, 4, { 1, 1, 5, 5, 5 } }, { 5, 7, { 1, 1, 7, 11, 19 } }, { 5, 11, { 1, 1, 5, 1, 1 } },
+        { 5, 13, { 1, 1, 1, 3, 11 } }, { 5, 14, { 1, 3, 5, 5, 31 } }, { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+        { 6, 13, { 1, 1, 1, 15, 21, 21 } }, { 6, 16, { 1, 3, 1, 13, 27, 49 } }, { 6, 19, { 1, 1, 1, 15, 7, 5 } },
+        { 6, 22, { 1, 3, 1, 15, 13, 25 } }, { 6, 25, { 1, 1, 5, 5, 19, 61 } }, { 7, 1, { 1, 3, 7, 11, 23, 15, 103 } },
+        { 7, 4, { 1, 3, 7, 13, 13, 15, 69 } },
+      };
+      constexpr auto TABULATED = sizeof(JOE_KUO) / sizeof(JOE_KUO[0]);
+
+      if (!dimensions())
+      {
+        return;
+      }
+
+      // the first dimension is the van der Corput sequence in base 2
+      FOR(bit, BITS)
+      {
+        _directions[bit] = uint32_t(1) << (BITS - 1 - bit);
+      }
+
+      // the polynomial after the last one used: x^degree + (coefficients << 1) + 1
+      uint64_t candidate = (uint64_t(1) << JOE_KUO[TABULATED - 1].degree) | (uint64_t(JOE_KUO[TABULATED - 1].coefficients) << 1) | 1;
+      for (size_t d = 1; d < dimensions(); ++d)
+      {
+        Polynomial p;
+        if (d - 1 < TABULATED)
+        {
+          p = JOE_KUO[d - 1];
+        }
+        else
+        {
+          do
+          {
+            candidate += 2;
+          } while (!isPrimitivePolynomial(candidate));
+
+          p.degree = static_cast<uint32_t>(std::bit_width(candidate)) - 1;
+          p.coefficients = static_cast<uint32_t>((candidate >> 1) & ((uint64_t(1) << (p.degree - 1)) - 1));
+          BulkRandomEngine engine(d);
+          FOR(k, p.degree)
+          {
+            // any odd m_k < 2^k gives a valid sequence
+            p.initial[k] = static_cast<uint32_t>(((engine() >> 40) & ((uint64_t(1) << k) - 1)) << 1 | 1);
+          }
+        }
+
+        auto v = &_directions[d * BITS];
+        const auto s = static_cast<int>(p.degree);
+        for (int k = 0; k < std::min(s, BITS); ++k)
+        {
+          v[k] = p.initial[k] << (BITS - 1 - k);
+        }
+        for (int k = s; k < BITS; ++k)
+        {
+          v[k] = v[k - s] ^ (v[k - s] >> s);
+          for (int j = 1; j < s; ++j)
+          {
+            if (p.coefficients >> (s - 1 - j) & 1)
+            {
+              v[k] ^= v[k - j];
+            }
+          }
+        }
+      }
+    }
+
+    std::vector<uint32_t> _directions;/*!< _directions[d * BITS + bit] - the direction numbers */
+    std::vector<uint32_t> _shift;/*!< the digital shift of every coordinate */
+    std::vector<uint32_t> _state;/*!< the next point, as 32 bit fractions */
+    uint64_t _index;/*!< the index of the next point */
+  };
+
+
+  /*! \class HaltonSequence "quasiRandom.h"
+    * \brief The scrambled Halton low discrepancy sequence in [0, 1)^dimensions.
+    *
+    * Dimension d is the radical inverse of the point index in the d-th prime base, with the digits
+    * permuted by a random permutation per dimension (0 stays 0). The plain Halton sequence has
+    * strongly correlated coordinates in the large bases; the permutations break the correlation.
+    * The index is kept as per dimension digits and incremented like an odometer. The coordinate is kept
+    * as the sums of its digit terms from every digit up, so an increment only updates the digits it
+    * carries through: O(1) amortized per coordinate, and no rounding error accumulates.
+    * \ingroup randomGenerators
+    */
+  class HaltonSequence
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param dimensions - the dimension of the points
+      * \param scrambleSeed - the seed of the digit permutations
+      */
+    explicit HaltonSequence(size_t dimensions, uint64_t scrambleSeed = 0x4a17) :
+      _bases(primes(dimensions))
+    , _digits(dimensions)
+    , _weights(dimensions)
+    , _permutations(dimensions)
+    , _sums(dimensions)
+    , _index(0)
+    {
+      BulkRandomEngine engine(scrambleSeed);
+      FOR(d, dimensions)
+      {
+        const auto base = _bases[d];
+
+        // enough digits for 2^64 points
+        size_t digits = 1;
+        for (auto reach = double(base); reach < 1.9e19; reach *= base)
+        {
+          ++digits;
+        }
+        _digits[d].assign(digits, 0);
+        _sums[d].assign(digits + 1, 0);
+        _weights[d].resize(digits);
+        auto weight = 1.0;
+        for (auto& w : _weights[d])
+        {
+          weight /= base;
+          w = weight;
+        }
+
+        auto& permutation = _permutations[d];
+        permutation.resize(base);
+        std::iota(permutation.begin(), permutation.end(), 0u);
+        for (auto i = base - 1; i > 1; --i)
+        {
+          std::swap(permutation[i], permutation[1 + engine() % i]);
+        }
+      }
+    }
+
+    //! the dimension of the points
+    size_t dimensions() const { return _bases.size(); }
+
+    //! the index of the next point
+    uint64_t index() const { return _index; }
+
+    /*!
+      * \brief Jumps to the given point in O(dimensions x digits), e.g. to split the sequence across threads
+      * \param index - the index of the next point
+      */
+    void skipTo(uint64_t index)
+    {
+      FOR(d, dimensions())
+      {
+        auto rest = index;
+        for (auto& digit : _digits[d])
+        {
+          digit = static_cast<uint32_t>(rest % _bases[d]);
+          rest /= _bases[d];
+        }
+        recompute(d);
+      }
+      _index = index;
+    }
+
+    /*!
+      * \brief Writes the next point, then advances the sequence
+      * \tparam Type - float or double
+      * \param out - the point; must have dimensions() coordinates
+      *
+      * \return true: the sequence has more points than a 64 bit index can count
+      */
+    template <typename Type>
+    bool next(std::span<Type> out)
+    {
+      for (size_t d = 0; d < dimensions(); ++d)
+      {
+        out[d] = static_cast<Type>(std::min(_sums[d][0], 1.0 - 0x1.0p-53));
+
+        // the carried digits wrap to 0, whose permuted value is 0: below the first digit that does not carry,
+        // the sums are all equal to its sum
+        auto& digits = _digits[d];
+        size_t k = 0;
+        for (; k + 1 < digits.size() && digits[k] + 1 == _bases[d]; ++k)
+        {
+          digits[k] = 0;
+        }
+        ++digits[k];
+        update(d, k);
+      }
+      ++_index;
+      return true;
+    }
+
+  protected:
+    //! recomputes the sums of the digits top..0, from the sum above top
+    void update(size_t d, size_t top)
+    {
+      auto& sums = _sums[d];
+      sums[top] = sums[top + 1] + _permutations[d][_digits[d][top]] * _weights[d][top];
+      for (size_t k = 0; k < top; ++k)
+      {
+        sums[k] = sums[top];
+      }
+    }
+
+    void recompute(size_t d)
+    {
+      auto& sums = _sums[d];
+      for (auto k = _digits[d].size(); k-- > 0;)
+      {
+        sums[k] = sums[k + 1] + _permutations[d][_digits[d][k]] * _weights[d][k];
+      }
+    }
+
+    static std::vector<uint32_t> primes(size_t count)
+    {
+      std::vector<uint32_t> result;
+      for (uint32_t candidate = 2; result.size() < count; ++candidate)
+      {
+        if (std::none_of(result.begin(), result.end(), [candidate](uint32_t p) { return candidate % p == 0; }))
+        {
+          result.push_back(candidate);
+        }
+      }
+      return result;
+    }
+
+    std::vector<uint32_t> _bases;/*!< the prime base of every dimension */
+    std::vector<std::vector<uint32_t>> _digits;/*!< the digits of the index in every base, lowest first */
+    std::vector<std::vector<double>> _weights;/*!< base^-(k + 1) */
+    std::vector<std::vector<uint32_t>> _permutations;/*!< the digit scrambling of every dimension */
+    std::vector<std::vector<double>> _sums;/*!< _sums[d][k] - the terms of the digits k and up of the next point's coordinate d */
+    uint64_t _index;/*!< the index of the next point */
+  };
+}
+
+#endif // !__QUASI_RANDOM_H__
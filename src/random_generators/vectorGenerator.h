@@ -9,8 +9,17 @@
 #define __VECTOR_GENERATOR_H__
 
 #include <xmemory>
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
 #include <random>
+#include <span>
 #include <type_traits>
+#include <vector>
+
+#include "../utility/Concepts.h"
+#include "bulkGenerator.h"
+#include "distributions.h"
 
 /*!
   \defgroup randomGenerators Utilities for random numbers generation
@@ -23,6 +32,9 @@ namespace randomGenerators
   enum class Distribution
   {
     UNIFORM = 0,/*!< uniform distributed numbers */
+    GAUSSIAN,/*!< normal distributed numbers (Ziggurat) */
+    CAUCHY,/*!< Cauchy distributed numbers: heavy tails */
+    LEVY,/*!< symmetric Levy-stable numbers (Mantegna, alpha = LEVY_ALPHA): heavy tails, Levy flights */
   };
 
   /*! \class Generator "vectorGenerator.h"
@@ -117,11 +129,33 @@ namespace randomGenerators
     }
   };
 
+  /*!
+    * \brief Derives an independent seed for a stream (a thread, a repetition) from a base seed.
+    *
+    * splitmix64 finalizer: neighbouring streams get unrelated seeds.
+    * \param seed - the base seed
+    * \param stream - the stream index
+    *
+    * \return the stream seed
+    * \ingroup randomGenerators
+    */
+  inline uint64_t mixSeed(uint64_t seed, uint64_t stream)
+  {
+    auto z = seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+
+
   /*! \class DefaultRandomEngine 
-    * \brief Singleton to get the random engine.
+    * \brief Per thread singleton to get the random engine.
     *
     * Creating the random engine every time it's needed can be an expensive proposition.
-    * Use this to get a default random engine.
+    * Use this to get a default random engine. Every thread owns its engine, so the algorithms
+    * can run concurrently without sharing (or racing on) the engine state: the first thread
+    * to use it is seeded with seed(), the next ones with mixSeed(seed(), thread ordinal).
+    * Every thread also owns a BulkRandomEngine (see bulk()), seeded from the same thread seed.
     *
     * \ingroup randomGenerators
     */
@@ -130,50 +164,190 @@ namespace randomGenerators
   public:
 
     /*!
-      * Gets an instance of the singleton
+      * Gets the calling thread's instance of the singleton
       * \return an instance of the singleton
       * \ingroup randomGenerators
       */
     static std::default_random_engine& get()
     {
-      static std::default_random_engine* s_randomEngine_ptr = nullptr;
-      if (!s_randomEngine_ptr)
+      thread_local std::default_random_engine s_randomEngine(static_cast<std::default_random_engine::result_type>(currentThreadSeed()));
+
+      return s_randomEngine;/*! the singleton instance */
+    }
+
+    /*!
+      * Gets the calling thread's bulk engine, used to fill whole buffers (see fillUniformRandom)
+      * \return the bulk engine
+      * \ingroup randomGenerators
+      */
+    static BulkRandomEngine& bulk()
+    {
+      thread_local BulkRandomEngine s_bulkEngine(mixSeed(currentThreadSeed(), BULK_STREAM));
+
+      return s_bulkEngine;
+    }
+
+    /*!
+      * Gets the base seed (drawn from std::random_device unless set)
+      * \return the seed
+      * \ingroup randomGenerators
+      */
+    static uint64_t seed()
+    {
+      return seedValue().load(std::memory_order_relaxed);
+    }
+
+    /*!
+      * Sets the base seed and reseeds the calling thread's engine, making the following runs reproducible
+      * \param value - the new seed
+      * \ingroup randomGenerators
+      */
+    static void seed(uint64_t value)
+    {
+      seedValue().store(value, std::memory_order_relaxed);
+      reseedThread(value);
+    }
+
+    /*!
+      * Reseeds only the calling thread's engine (e.g. per benchmark repetition); the base seed is unchanged
+      * \param value - the new seed
+      * \ingroup randomGenerators
+      */
+    static void reseedThread(uint64_t value)
+    {
+      currentThreadSeed() = value;
+      get().seed(static_cast<std::default_random_engine::result_type>(value));
+      bulk().seed(mixSeed(value, BULK_STREAM));
+    }
+
+    /*! \class ThreadStateGuard
+      * \brief Saves the calling thread's engines, and puts them back as they were when it goes out of scope.
+      *
+      * Lets a parallel loop reseed the engines of the threads running it (the caller's included, see
+      * utility::ThreadPool::parallelFor) for reproducible chunks, without leaving a trace on their streams.
+      * \ingroup randomGenerators
+      */
+    class ThreadStateGuard
+    {
+    public:
+      ThreadStateGuard() :
+        _seed(currentThreadSeed())
+      , _engine(get())
+      , _bulk(bulk())
       {
-        std::random_device randomDevice;
-        static std::default_random_engine s_randomEngine(randomDevice());
-        s_randomEngine_ptr = &s_randomEngine;
+        ;
       }
 
-      return *s_randomEngine_ptr;/*! the singleton instance */
-    }
+      ~ThreadStateGuard()
+      {
+        currentThreadSeed() = _seed;
+        get() = _engine;
+        bulk() = _bulk;
+      }
+
+      ThreadStateGuard(const ThreadStateGuard&) = delete;
+      ThreadStateGuard& operator=(const ThreadStateGuard&) = delete;
+
+    protected:
+      uint64_t _seed;/*!< the thread seed */
+      std::default_random_engine _engine;/*!< the state of get() */
+      BulkRandomEngine _bulk;/*!< the state of bulk() */
+    };
   protected:    
+    static constexpr uint64_t BULK_STREAM = 0xB01C;/*!< the bulk engine's stream, so it does not replay the default engine */
+
+    static uint64_t& currentThreadSeed()
+    {
+      thread_local uint64_t s_threadSeed = threadSeed();
+      return s_threadSeed;
+    }
+
+    static std::atomic<uint64_t>& seedValue()
+    {
+      static std::atomic<uint64_t> s_seed{ std::random_device()() };
+      return s_seed;
+    }
+
+    static uint64_t threadSeed()
+    {
+      static std::atomic<uint64_t> s_threads(0);
+      const auto ordinal = s_threads.fetch_add(1, std::memory_order_relaxed);
+      return ordinal ? mixSeed(seed(), ordinal) : seed();
+    }
   };
 
 
+  /*!
+    * \brief Fills a preallocated buffer with uniform distributed random numbers.
+    * float, double and integers up to 32 bits are generated in bulk by the thread's BulkRandomEngine;
+    * other types go through the standard distributions, one number at a time.
+    *
+    * \tparam Type: the type of the numbers to populate the buffer;
+    * \tparam TypeType: the numbers sub-type;
+    * \param out: the buffer to fill (any contiguous range of TypeType converts to it);
+    * \param min: the smallest random number possible;
+    * \param max: the largest random number possible;
+    * \ingroup randomGenerators
+    */
+  template <class Type, class TypeType = Type>
+  void fillUniformRandom(std::type_identity_t<std::span<TypeType>> out, Type min, Type max)
+  {
+    if constexpr (std::is_same_v<TypeType, double> || std::is_same_v<TypeType, float> ||
+                  (std::is_integral_v<TypeType> && sizeof(TypeType) <= sizeof(uint32_t)))
+    {
+      DefaultRandomEngine::bulk().fillUniform<TypeType>(out, static_cast<TypeType>(min), static_cast<TypeType>(max));
+    }
+    else
+    {
+      auto& randomEngine = DefaultRandomEngine::get();
+      UniformDistributedGenerator<Type, TypeType> generate(min, max);
+      for (auto& value : out)
+      {
+        value = generate(randomEngine);
+      }
+    }
+  }
+
+
   /*!
     * \brief Creates an uniform distributed random set of numbers.
     *
     * \tparam Type: the type of the numbers to populate the container;
     * \tparam TypeType: the numbers sub-type;
-    * \tparam Container: the container type to be filled - std::vector<Type>;
+    * \tparam Container: the container type to be filled - any contiguous container of TypeType constructible with a size;
     * \param size: the number of random numbers to be created;
     * \param min: the smallest random number possible;
     * \param max: the largest random number possible;
     * \ingroup randomGenerators
     */
-  template <class Type, class TypeType, template <class, class> class Container>
-  Container<TypeType, std::allocator<TypeType>> generateUniformRandomContainer(size_t size, Type min, Type max)
+  template <class Type, class TypeType = Type, utility::SizedContainerOf<TypeType> Container = std::vector<TypeType>>
+  Container generateUniformRandomContainer(size_t size, Type min, Type max)
   {
-    auto& randomEngine = DefaultRandomEngine::get();
-    Container<TypeType, std::allocator<TypeType>> vect;    
-    vect.reserve(size);
-    UniformDistributedGenerator<Type, TypeType> generate(min, max);
-    for (int i = 0; i < size; ++i)
-    {
-      vect.push_back(generate(randomEngine));
-    }
+    Container container(size);
+    fillUniformRandom<Type, TypeType>(utility::asSpan(container), min, max);
 
-    return vect;
+    return container;
+  }
+
+
+  /*!
+    * \brief Creates an uniform distributed random set of numbers, allocated from the given memory resource.
+    *
+    * \tparam Type: the type of the numbers to populate the container;
+    * \tparam TypeType: the numbers sub-type;
+    * \param size: the number of random numbers to be created;
+    * \param min: the smallest random number possible;
+    * \param max: the largest random number possible;
+    * \param memory: the memory resource (e.g. utility::RunArena::resource());
+    * \ingroup randomGenerators
+    */
+  template <class Type, class TypeType = Type>
+  std::pmr::vector<TypeType> generateUniformRandomContainer(size_t size, Type min, Type max, std::pmr::memory_resource* memory)
+  {
+    std::pmr::vector<TypeType> container(size, TypeType(), memory);
+    fillUniformRandom<Type, TypeType>(container, min, max);
+
+    return container;
   }
 
 
@@ -199,29 +373,127 @@ namespace randomGenerators
 
 
   /*!
-    * \brief generates a vector of random numbers
-    * \tparam Type: numbers type
-    * \tparam TypeType: numbers sub-type
-    * \param size: the number of random numbers to be created
-    * \param min: the smallest random number possible
-    * \param max: the largest random number possible
+    * \brief Fills a preallocated buffer with unbounded random numbers centered on location
+    * Uniform numbers are in [location - scale, location + scale); the others use scale as their
+    * standard deviation (Gaussian), half width at half maximum (Cauchy) or scale (Levy).
+    * \tparam Type: float or double
+    * \param out: the buffer to fill (any contiguous range of Type converts to it)
+    * \param location: the center of the distribution
+    * \param scale: the spread of the distribution
     * \param distribution: the random distribution to follow
-    * \return the std::vector<Type> created
     * \ingroup randomGenerators
     */
-  template <class Type, template <class, class> class Container, class TypeType = Type>
-  Container<TypeType, std::allocator<TypeType>> generateRandomVector(size_t size, Type min, Type max, Distribution distribution)
+  template <class Type>
+  void fillRandom(std::type_identity_t<std::span<Type>> out, Type location, Type scale, Distribution distribution)
   {
+    auto& engine = DefaultRandomEngine::bulk();
     switch (distribution)
     {
       default:
       case Distribution::UNIFORM:
       {
-        return generateUniformRandomContainer<Type, TypeType, std::vector>(size, min, max);
+        engine.fillUniform<Type>(out, location - scale, location + scale);
+      }
+      break;
+      case Distribution::GAUSSIAN:
+      {
+        fillGaussian<Type>(engine, out, location, scale);
+      }
+      break;
+      case Distribution::CAUCHY:
+      {
+        fillCauchy<Type>(engine, out, location, scale);
+      }
+      break;
+      case Distribution::LEVY:
+      {
+        fillLevy<Type>(engine, out, static_cast<Type>(LEVY_ALPHA), scale);
+        for (auto& value : out)
+        {
+          value += location;
+        }
       }
       break;
     }
   }
+
+
+  /*!
+    * \brief fills a preallocated buffer with random numbers
+    * The non-uniform distributions are centered on (min + max) / 2, with half of the interval as
+    * their scale (see fillRandom), and truncated to [min, max]: the numbers outside are redrawn.
+    * Integer types only support the uniform distribution.
+    * \tparam Type: numbers type
+    * \tparam TypeType: numbers sub-type
+    * \param out: the buffer to fill (any contiguous range of TypeType converts to it)
+    * \param min: the smallest random number possible
+    * \param max: the largest random number possible
+    * \param distribution: the random distribution to follow
+    * \ingroup randomGenerators
+    */
+  template <class Type, class TypeType = Type>
+  void generateRandomVector(std::type_identity_t<std::span<TypeType>> out, Type min, Type max, Distribution distribution)
+  {
+    if constexpr (std::is_same_v<TypeType, double> || std::is_same_v<TypeType, float>)
+    {
+      if (distribution != Distribution::UNIFORM)
+      {
+        const auto location = static_cast<TypeType>((min + max) / 2);
+        const auto scale = static_cast<TypeType>((max - min) / 2);
+        const auto fill = [&](std::span<TypeType> buffer) { fillRandom<TypeType>(buffer, location, scale, distribution); };
+
+        fill(out);
+        truncate<TypeType>(out, static_cast<TypeType>(min), static_cast<TypeType>(max), fill);
+        return;
+      }
+    }
+
+    fillUniformRandom<Type, TypeType>(out, min, max);
+  }
+
+
+  /*!
+    * \brief generates a vector of random numbers
+    * \tparam Type: numbers type
+    * \tparam TypeType: numbers sub-type
+    * \tparam Container: the container type - any contiguous container of TypeType constructible with a size
+    * \param size: the number of random numbers to be created
+    * \param min: the smallest random number possible
+    * \param max: the largest random number possible
+    * \param distribution: the random distribution to follow
+    * \return the Container created
+    * \ingroup randomGenerators
+    */
+  template <class Type, class TypeType = Type, utility::SizedContainerOf<TypeType> Container = std::vector<TypeType>>
+  Container generateRandomVector(size_t size, Type min, Type max, Distribution distribution)
+  {
+    Container container(size);
+    generateRandomVector<Type, TypeType>(utility::asSpan(container), min, max, distribution);
+
+    return container;
+  }
+
+
+  /*!
+    * \brief generates a vector of random numbers, allocated from the given memory resource
+    * \tparam Type: numbers type
+    * \tparam TypeType: numbers sub-type
+    * \param size: the number of random numbers to be created
+    * \param min: the smallest random number possible
+    * \param max: the largest random number possible
+    * \param distribution: the random distribution to follow
+    * \param memory: the memory resource (e.g. utility::RunArena::resource())
+    * \return the std::pmr::vector<TypeType> created
+    * \ingroup randomGenerators
+    */
+  template <class Type, class TypeType = Type>
+  std::pmr::vector<TypeType> generateRandomVector(size_t size, Type min, Type max, Distribution distribution, std::pmr::memory_resource* memory)
+  {
+    std::pmr::vector<TypeType> container(size, TypeType(), memory);
+    generateRandomVector<Type, TypeType>(container, min, max, distribution);
+
+    return container;
+  }
 }
 
 #endif // !__VECTOR_GENERATOR_H__
@@ -1 +1,360 @@
-#include "benchmark.h"
\ No newline at end of file
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <limits>
+#include <map>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "../utility/Parallel.h"
+#include "../random_generators/vectorGenerator.h"
+#include "benchmark.h"
+
+namespace
+{
+  const char* CSV_HEADER =
+    "host,compiler,threads,seed,base,name,iterations,mean_ms,mean_ci_low_ms,mean_ci_high_ms,"
+    "median_ms,median_ci_low_ms,median_ci_high_ms,p90_ms,p99_ms,stddev_ms,best_ms,worst_ms,outliers,average_result,"
+    "cycles,instructions,cache_misses,branch_misses,time_to_target_ms,target_hit_rate,auc,times_ms,results";
+
+  std::string hostName()
+  {
+#if defined(_WIN32)
+    char name[MAX_COMPUTERNAME_LENGTH + 1] = {};
+    DWORD size = sizeof(name);
+    return GetComputerNameA(name, &size) ? std::string(name, size) : std::string("unknown");
+#else
+    char name[256] = {};
+    return gethostname(name, sizeof(name) - 1) == 0 ? std::string(name) : std::string("unknown");
+#endif
+  }
+
+  std::string compilerName()
+  {
+#if defined(_MSC_VER)
+    return "MSVC " + std::to_string(_MSC_FULL_VER);
+#elif defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#else
+    return "unknown";
+#endif
+  }
+
+  //! quotes a CSV field when it holds a separator, a quote or a line break
+  std::string csvField(const std::string& value)
+  {
+    if (value.find_first_of(",\"\r\n") == std::string::npos)
+    {
+      return value;
+    }
+
+    std::string quoted = "\"";
+    for (auto c : value)
+    {
+      quoted += c;
+      if (c == '"')
+      {
+        quoted += '"';
+      }
+    }
+    return quoted + "\"";
+  }
+
+  //! splits one CSV record; quoted fields may hold separators and doubled quotes
+  std::vector<std::string> csvSplit(const std::string& line)
+  {
+    std::vector<std::string> fields(1);
+    auto quoted = false;
+    for (size_t i = 0; i < line.size(); ++i)
+    {
+      const auto c = line[i];
+      if (quoted)
+      {
+        if (c == '"' && i + 1 < line.size() && line[i + 1] == '"')
+        {
+          fields.back() += c;
+          ++i;
+        }
+        else if (c == '"')
+        {
+          quoted = false;
+        }
+        else
+        {
+          fields.back() += c;
+        }
+      }
+      else if (c == '"')
+      {
+        quoted = true;
+      }
+      else if (c == ',')
+      {
+        fields.emplace_back();
+      }
+      else if (c != '\r')
+      {
+        fields.back() += c;
+      }
+    }
+
+    return fields;
+  }
+
+  //! an unavailable counter is exported as an empty CSV field / a JSON null
+  std::string counterValue(const statistics::HardwareCounters& counters, statistics::HardwareEvent event, const char* missing)
+  {
+    return counters.has(event) ? std::to_string(counters[event]) : std::string(missing);
+  }
+
+  //! the anytime metrics only exist for algorithms reporting their convergence; unreached targets are infinite
+  std::string convergenceValue(const statistics::Benchmark::AlgorithmStatistics& a, double value, const char* missing)
+  {
+    if (!a.observed() || !std::isfinite(value))
+    {
+      return missing;
+    }
+
+    std::ostringstream number;
+    number << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+    return number.str();
+  }
+
+  //! the per run samples, for the rank tests of Benchmark::compare: space separated in CSV, an array in JSON
+  std::string sampleList(const std::vector<double>& values, const char* separator)
+  {
+    std::ostringstream list;
+    list << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (auto& value : values)
+    {
+      list << (&value == values.data() ? "" : separator) << value;
+    }
+    return list.str();
+  }
+
+  //! a whole field must be a number
+  bool parseNumber(const std::string& field, double& value)
+  {
+    char* end = nullptr;
+    value = std::strtod(field.c_str(), &end);
+    return !field.empty() && end == field.c_str() + field.size();
+  }
+
+  //! the inverse of sampleList(values, " ")
+  bool parseSamples(const std::string& field, std::vector<double>& values)
+  {
+    values.clear();
+    const char* position = field.c_str();
+    while (*position)
+    {
+      char* end = nullptr;
+      values.push_back(std::strtod(position, &end));
+      if (end == position)
+      {
+        return false;
+      }
+      for (position = end; *position == ' '; ++position);
+    }
+    return true;
+  }
+
+  std::string jsonString(const std::string& value)
+  {
+    std::ostringstream quoted;
+    quoted << '"';
+    for (auto c : value)
+    {
+      switch (c)
+      {
+      case '"': quoted << "\\\""; break;
+      case '\\': quoted << "\\\\"; break;
+      case '\n': quoted << "\\n"; break;
+      case '\r': quoted << "\\r"; break;
+      case '\t': quoted << "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20)
+        {
+          quoted << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+        }
+        else
+        {
+          quoted << c;
+        }
+      }
+    }
+    quoted << '"';
+    return quoted.str();
+  }
+
+  //! JSON has no representation for infinities and NaN
+  std::string jsonNumber(double value)
+  {
+    if (!std::isfinite(value))
+    {
+      return "null";
+    }
+
+    std::ostringstream number;
+    number << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
+    return number.str();
+  }
+}
+
+statistics::BenchmarkEnvironment statistics::BenchmarkEnvironment::current()
+{
+  BenchmarkEnvironment environment;
+  environment.host = hostName();
+  environment.compiler = compilerName();
+  environment.threads = utility::hardwareThreads();
+  environment.seed = randomGenerators::DefaultRandomEngine::seed();
+
+  return environment;
+}
+
+void statistics::Benchmark::writeCsv(std::ostream& out) const
+{
+  const auto environment = BenchmarkEnvironment::current();
+
+  out << CSV_HEADER << "\n";
+  const auto precision = out.precision(std::numeric_limits<double>::max_digits10);
+  for (auto& a : table)
+  {
+    out << csvField(environment.host) << ',' << csvField(environment.compiler) << ',' << environment.threads << ',' << environment.seed << ','
+        << a.base() << ',' << csvField(a.name()) << ',' << a.iterations() << ','
+        << a.timeMillis() << ',' << a.meanInterval().low << ',' << a.meanInterval().high << ','
+        << a.medianTime() << ',' << a.medianInterval().low << ',' << a.medianInterval().high << ','
+        << a.p90Time() << ',' << a.p99Time() << ',' << a.standardDeviation() << ','
+        << a.bestTime() << ',' << a.worstTime() << ',' << a.outliers() << ',' << a.averageResult() << ','
+        << counterValue(a.counters(), HardwareEvent::CYCLES, "") << ',' << counterValue(a.counters(), HardwareEvent::INSTRUCTIONS, "") << ','
+        << counterValue(a.counters(), HardwareEvent::CACHE_MISSES, "") << ',' << counterValue(a.counters(), HardwareEvent::BRANCH_MISSES, "") << ','
+        << convergenceValue(a, a.timeToTarget(), "") << ',' << convergenceValue(a, a.targetHitRate(), "") << ',' << convergenceValue(a, a.areaUnderCurve(), "") << ','
+        << sampleList(a.times(), " ") << ',' << sampleList(a.results(), " ") << "\n";
+  }
+  out.precision(precision);
+}
+
+void statistics::Benchmark::writeJson(std::ostream& out) const
+{
+  const auto environment = BenchmarkEnvironment::current();
+
+  out << "{\n";
+  out << "  \"environment\": {\n";
+  out << "    \"host\": " << jsonString(environment.host) << ",\n";
+  out << "    \"compiler\": " << jsonString(environment.compiler) << ",\n";
+  out << "    \"threads\": " << environment.threads << ",\n";
+  out << "    \"seed\": " << environment.seed << "\n";
+  out << "  },\n";
+  out << "  \"algorithms\": [";
+
+  auto first = true;
+  for (auto& a : table)
+  {
+    out << (first ? "\n" : ",\n");
+    first = false;
+
+    out << "    {\n";
+    out << "      \"name\": " << jsonString(a.name()) << ",\n";
+    out << "      \"base\": " << (a.base() ? "true" : "false") << ",\n";
+    out << "      \"iterations\": " << a.iterations() << ",\n";
+    out << "      \"mean_ms\": " << jsonNumber(a.timeMillis()) << ",\n";
+    out << "      \"mean_ci_ms\": [" << jsonNumber(a.meanInterval().low) << ", " << jsonNumber(a.meanInterval().high) << "],\n";
+    out << "      \"median_ms\": " << jsonNumber(a.medianTime()) << ",\n";
+    out << "      \"median_ci_ms\": [" << jsonNumber(a.medianInterval().low) << ", " << jsonNumber(a.medianInterval().high) << "],\n";
+    out << "      \"p90_ms\": " << jsonNumber(a.p90Time()) << ",\n";
+    out << "      \"p99_ms\": " << jsonNumber(a.p99Time()) << ",\n";
+    out << "      \"stddev_ms\": " << jsonNumber(a.standardDeviation()) << ",\n";
+    out << "      \"best_ms\": " << jsonNumber(a.bestTime()) << ",\n";
+    out << "      \"worst_ms\": " << jsonNumber(a.worstTime()) << ",\n";
+    out << "      \"outliers\": " << a.outliers() << ",\n";
+    out << "      \"average_result\": " << jsonNumber(a.averageResult()) << ",\n";
+    out << "      \"cycles\": " << counterValue(a.counters(), HardwareEvent::CYCLES, "null") << ",\n";
+    out << "      \"instructions\": " << counterValue(a.counters(), HardwareEvent::INSTRUCTIONS, "null") << ",\n";
+    out << "      \"cache_misses\": " << counterValue(a.counters(), HardwareEvent::CACHE_MISSES, "null") << ",\n";
+    out << "      \"branch_misses\": " << counterValue(a.counters(), HardwareEvent::BRANCH_MISSES, "null") << ",\n";
+    out << "      \"time_to_target_ms\": " << convergenceValue(a, a.timeToTarget(), "null") << ",\n";
+    out << "      \"target_hit_rate\": " << convergenceValue(a, a.targetHitRate(), "null") << ",\n";
+    out << "      \"auc\": " << convergenceValue(a, a.areaUnderCurve(), "null") << ",\n";
+    out << "      \"times_ms\": [" << sampleList(a.times(), ", ") << "],\n";
+    out << "      \"results\": [" << sampleList(a.results(), ", ") << "]\n";
+    out << "    }";
+  }
+
+  out << (first ? "]\n" : "\n  ]\n");
+  out << "}\n";
+}
+
+std::optional<std::vector<statistics::Regression>> statistics::Benchmark::compare(std::istream& previousCsv, std::string& error, const RegressionThresholds& thresholds) const
+{
+  std::vector<Regression> regressions;
+
+  std::string line;
+  if (!std::getline(previousCsv, line))
+  {
+    error = "the previous results are empty";
+    return std::nullopt;
+  }
+
+  std::map<std::string, size_t> columns;
+  const auto header = csvSplit(line);
+  FOR(i, header.size())
+  {
+    columns[header[i]] = i;
+  }
+  for (auto column : { "name", "median_ms", "average_result", "times_ms", "results" })
+  {
+    if (!columns.count(column))
+    {
+      error = std::string("the previous results have no ") + column + " column";
+      return std::nullopt;
+    }
+  }
+
+  for (size_t row = 2; std::getline(previousCsv, line); ++row)
+  {
+    if (line.empty() || line == "\r")
+    {
+      continue;
+    }
+    const auto fields = csvSplit(line);
+
+    double previousMedian = 0, previousResult = 0;
+    std::vector<double> previousTimes, previousResults;
+    if (fields.size() != header.size()
+      || !parseNumber(fields[columns["median_ms"]], previousMedian) || !parseNumber(fields[columns["average_result"]], previousResult)
+      || !parseSamples(fields[columns["times_ms"]], previousTimes) || !parseSamples(fields[columns["results"]], previousResults))
+    {
+      error = "malformed line " + std::to_string(row) + " in the previous results";
+      return std::nullopt;
+    }
+
+    for (auto& a : table)
+    {
+      if (a.name() != fields[columns["name"]])
+      {
+        continue;
+      }
+
+      // slower beyond the threshold, and not explained by the noise of either run
+      if (a.medianTime() > previousMedian * (1 + thresholds.time) && mannWhitneyU(a.times(), previousTimes) < thresholds.significance)
+      {
+        regressions.push_back({ a.name(), "median time", previousMedian, a.medianTime() });
+      }
+
+      const auto degradation = thresholds.minimize ? a.averageResult() - previousResult : previousResult - a.averageResult();
+      if (degradation > thresholds.quality * std::abs(previousResult) && mannWhitneyU(a.results(), previousResults) < thresholds.significance)
+      {
+        regressions.push_back({ a.name(), "average result", previousResult, a.averageResult() });
+      }
+    }
+  }
+
+  return regressions;
+}
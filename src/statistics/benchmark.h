@@ -7,21 +7,206 @@
 #ifndef __BENCHMARK_H__
 #define __BENCHMARK_H__
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <list>
+#include <vector>
 #include <sstream>
+#include <iostream>
+#include <optional>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
 
 #include "../utility/Defines.h"
 #include "clock.h"
+#include "sampleStatistics.h"
+#include "perfCounters.h"
+#include "convergence.h"
 
 namespace statistics {
+  /*! \class BenchmarkOptions "benchmark.h"
+    * \brief How an algorithm is measured by Benchmark::AlgorithmStatistics.
+    * \ingroup statistics
+    */
+  struct BenchmarkOptions
+  {
+    size_t warmup = 3;/*!< untimed runs before the measurement (caches, branch predictors, page faults, lazy statics) */
+    double outlierFactor = 1.5;/*!< Tukey fence factor for the rejection of timing outliers; 0 keeps every sample */
+    size_t bootstrapResamples = 2000;/*!< number of bootstrap resamples for the confidence intervals */
+    double confidence = 0.95;/*!< confidence level of the bootstrap intervals */
+    TimeSource timeSource = TimeSource::STEADY_CLOCK;/*!< the clock used for the measurements */
+    bool hardwareCounters = false;/*!< also count cycles, instructions, cache and branch misses (see PerfCounters) */
+    std::optional<double> target;/*!< the "good enough" cost for the time to target metric (algorithms taking a ConvergenceRecorder&) */
+    bool minimize = true;/*!< lower costs are better (time to target) */
+    double horizonMillis = 0;/*!< the horizon of the area under the convergence curve; 0 means each run's last improvement */
+    size_t convergenceCapacity = 4096;/*!< the improvements recorded per run */
+  };
+
+
+  /*! \class RepetitionSample "benchmark.h"
+    * \brief What one timed run of an algorithm measured.
+    * \ingroup statistics
+    */
+  struct RepetitionSample
+  {
+    double timeMillis = 0;/*!< the duration of the run */
+    double result = 0;/*!< the value returned by the algorithm */
+    HardwareCounters counters;/*!< the hardware events (empty unless BenchmarkOptions::hardwareCounters) */
+    double timeToTarget = std::numeric_limits<double>::infinity();/*!< when the target was reached (anytime algorithms only) */
+    double areaUnderCurve = 0;/*!< see ConvergenceRecorder::areaUnderCurve (anytime algorithms only) */
+  };
+
+
+  /*! \class Repetitions "benchmark.h"
+    * \brief Runs and measures repetitions of an algorithm on the calling thread.
+    *
+    * Owns the per thread measurement state (the convergence recorder, the hardware counters),
+    * so every thread measuring the algorithm needs its own instance.
+    * \tparam Function - the algorithm: double() or double(ConvergenceRecorder&)
+    * \ingroup statistics
+    */
+  template <class Function>
+  class Repetitions
+  {
+  public:
+    //! anytime algorithms report their improvements into a ConvergenceRecorder
+    static constexpr bool observed = std::is_invocable_v<Function&, ConvergenceRecorder&>;
+
+    /*!
+      * \brief init c-tor
+      * \param options - how the algorithm is measured
+      * \param algorithm - the algorithm; must outlive the object
+      */
+    Repetitions(const BenchmarkOptions& options, Function& algorithm) :
+      _options(options)
+    , _algorithm(algorithm)
+    , _recorder(observed ? options.convergenceCapacity : 1)
+    {
+      // the counters are only opened on request; failing to open them just leaves the samples' counters empty
+      if (options.hardwareCounters)
+      {
+        _perfCounters.emplace();
+      }
+    }
+
+    //! the untimed warmup runs: the results are stored to a volatile so the runs are not optimized away
+    void warmup()
+    {
+      [[maybe_unused]] volatile double sink = 0;
+      FOR(i, _options.warmup)
+      {
+        sink = call();
+      }
+    }
+
+    //! runs and measures one repetition
+    RepetitionSample run()
+    {
+      RepetitionSample sample;
+      const auto timed = [this, &sample]()
+      {
+        sample.result = call();
+      };
+
+      if (_perfCounters && _perfCounters->available())
+      {
+        sample.timeMillis = clock(timed, *_perfCounters, sample.counters, _options.timeSource);
+      }
+      else
+      {
+        sample.timeMillis = clock(timed, _options.timeSource);
+      }
+
+      if constexpr (observed)
+      {
+        sample.areaUnderCurve = _recorder.areaUnderCurve(_options.horizonMillis);
+        if (_options.target)
+        {
+          sample.timeToTarget = _recorder.timeToTarget(*_options.target, _options.minimize);
+        }
+      }
+
+      return sample;
+    }
+
+  protected:
+    double call()
+    {
+      if constexpr (observed)
+      {
+        _recorder.start();
+        return _algorithm(_recorder);
+      }
+      else
+      {
+        return _algorithm();
+      }
+    }
+
+    const BenchmarkOptions& _options;
+    Function& _algorithm;
+    ConvergenceRecorder _recorder;
+    std::optional<PerfCounters> _perfCounters;
+  };
+
+
+  /*! \class BenchmarkEnvironment "benchmark.h"
+    * \brief Where the benchmark ran; exported with the results so runs on different setups are not compared blindly.
+    * \ingroup statistics
+    */
+  struct BenchmarkEnvironment
+  {
+    std::string host;/*!< the machine name */
+    std::string compiler;/*!< the compiler and its version */
+    size_t threads = 0;/*!< the number of hardware threads */
+    uint64_t seed = 0;/*!< the seed of the default random engine */
+
+    /*!
+      * \brief Describes the current process.
+      * \return the environment
+      */
+    static BenchmarkEnvironment current();
+  };
+
+
+  /*! \class RegressionThresholds "benchmark.h"
+    * \brief When Benchmark::compare reports a regression.
+    * \ingroup statistics
+    */
+  struct RegressionThresholds
+  {
+    double time = 0.05;/*!< tolerated relative increase of the median time */
+    double quality = 0.01;/*!< tolerated relative degradation of the average result */
+    double significance = 0.01;/*!< a change is only reported when the Mann-Whitney test on the per run samples is significant at this level */
+    bool minimize = true;/*!< lower results are better */
+  };
+
+
+  /*! \class Regression "benchmark.h"
+    * \brief An algorithm that got worse than in a previous run.
+    * \ingroup statistics
+    */
+  struct Regression
+  {
+    std::string name;/*!< the algorithm */
+    std::string metric;/*!< "median time" or "average result" */
+    double previous = 0;/*!< the previous value */
+    double current = 0;/*!< the current value */
+  };
+
+
   /*! \class Benchmark
     * \brief Class to benchmark algorithms.
     *
-    *  Base | Algorithm | Iterations | Time |Best Time|Worst time| Average result | Variance from base average
-    *  :--: | :-------: | :--------: | :--: | :-----: | :------: | :------------: | :------------------------:
-    *   1/0 |  name     |     #      | ms   |  ms     | ms       |    -           |                -
+    *  Base | Algorithm | Iterations | Time |Best Time|Worst time| Median [CI] | p90 | p99 | Std dev | Outliers | Average result | Variance from base average | vs base
+    *  :--: | :-------: | :--------: | :--: | :-----: | :------: | :---------: | :-: | :-: | :-----: | :------: | :------------: | :------------------------: | :-----:
+    *   1/0 |  name     |     #      | ms   |  ms     | ms       | ms [ms, ms] | ms  | ms  | ms      |    #     |    -           |                -           | ratio, p-value
     *
+    * The time statistics are computed after the outlier rejection; best and worst time cover every timed run.
+    * Algorithms callable as double(ConvergenceRecorder&) also get the anytime metrics: the median time to target
+    * (over the runs that reached it), the fraction of runs reaching the target and the mean area under the convergence curve.
     * \ingroup statistics
     */
   class Benchmark
@@ -41,11 +226,51 @@ namespace statistics {
       DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, averageResult)
       DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, worstTime)
       DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, bestTime)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, medianTime)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, p90Time)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, p99Time)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, standardDeviation)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(size_t, outliers)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(ConfidenceInterval, medianInterval)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(ConfidenceInterval, meanInterval)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(std::vector<double>, times)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(std::vector<double>, results)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(HardwareCounters, counters)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(bool, observed)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, timeToTarget)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, targetHitRate)
+      DECLARE_PROTECTED_TRIVIAL_ATTRIBUTE_C(double, areaUnderCurve)
 
 
       /*!
         * \brief Init c-tor.
         * Executes the algorithm and collects statistics
+        * \tparam Function - the algorithm function type: double() or double(ConvergenceRecorder&)
+        *
+        * \param options - how the algorithm is measured
+        * \param iterations - the number of timed iterations to execute
+        * \param name - the name of the algorithm
+        * \param isBase - this is the base algorithm (there can be only one)
+        * \param algorithm - the function that executes the algorithm
+        */
+      template <class Function>
+      inline AlgorithmStatistics(const BenchmarkOptions& options, size_t iterations, const char* name, bool isBase, Function algorithm);
+
+      /*!
+        * \brief Init c-tor.
+        * Collects statistics from repetitions measured elsewhere (see BenchmarkRunner)
+        *
+        * \param options - how the algorithm was measured
+        * \param name - the name of the algorithm
+        * \param isBase - this is the base algorithm (there can be only one)
+        * \param observed - the algorithm reported its convergence
+        * \param samples - the measured repetitions
+        */
+      inline AlgorithmStatistics(const BenchmarkOptions& options, const char* name, bool isBase, bool observed, const std::vector<RepetitionSample>& samples);
+
+      /*!
+        * \brief Init c-tor.
+        * Executes the algorithm and collects statistics using the default BenchmarkOptions
         * \tparam Function - the algorithm function type
         * \tparam Args - the Arguments
         *
@@ -60,7 +285,7 @@ namespace statistics {
       
       /*!
         * \brief Init c-tor.
-        * Executes the algorithm and collects statistics
+        * Executes the algorithm and collects statistics using the default BenchmarkOptions
         * \tparam Function - the algorithm function type        
         *
         * \param iterations - the number of iterations to execute
@@ -79,13 +304,21 @@ namespace statistics {
       , _averageResult(0)
       , _worstTime(0)
       , _bestTime(std::numeric_limits<double>::max())
+      , _medianTime(0)
+      , _p90Time(0)
+      , _p99Time(0)
+      , _standardDeviation(0)
+      , _outliers(0)
+      , _observed(false)
+      , _timeToTarget(std::numeric_limits<double>::infinity())
+      , _targetHitRate(0)
+      , _areaUnderCurve(0)
       {
         ;
       }
     };
   public:
 
-
     /*!
       * \brief Adds an algorithm to the benchmark
       *
@@ -105,8 +338,10 @@ namespace statistics {
 
     /*!
       * \brief Prints the benchmark results to console
+      *
+      * \param significance - the significance level of the Mann-Whitney test against the base algorithm
       */
-    void printResults()
+    void printResults(double significance = 0.05)
     {
       std::stringstream info;
       for (auto& a : table)
@@ -114,87 +349,173 @@ namespace statistics {
         info << "Is base: " << a.base() << "; " << std::endl;
         info << "Algorithm: " << a.name() << "; " << std::endl;
         info << "Iterations: " << a.iterations() << "; " << std::endl;
-        info << "Average Time: " << a.timeMillis() << " ms; " << std::endl;
+        info << "Average Time: " << a.timeMillis() << " ms [" << a.meanInterval().low << ", " << a.meanInterval().high << "]; " << std::endl;
+        info << "Median Time: " << a.medianTime() << " ms [" << a.medianInterval().low << ", " << a.medianInterval().high << "]; " << std::endl;
+        info << "p90 / p99: " << a.p90Time() << " / " << a.p99Time() << " ms; " << std::endl;
+        info << "Standard deviation: " << a.standardDeviation() << " ms; " << std::endl;
+        info << "Outliers rejected: " << a.outliers() << "; " << std::endl;
         info << "Best time: " << a.bestTime() << " ms; " << std::endl;
         info << "Worst time: " << a.worstTime() << " ms; " << std::endl;
         info << "Average result: " << a.averageResult() << "; " << std::endl;
-        info << "Variance from base: " << std::abs(base->averageResult() - a.averageResult()) << "; " << std::endl;
+        if (a.observed())
+        {
+          info << "Time to target: " << a.timeToTarget() << " ms (" << a.targetHitRate() * 100 << "% of the runs); " << std::endl;
+          info << "Area under the convergence curve: " << a.areaUnderCurve() << "; " << std::endl;
+        }
+        if (a.counters().available)
+        {
+          info << "IPC: " << a.counters().ipc()
+               << "; cache misses / 1k instructions: " << a.counters().perKiloInstruction(HardwareEvent::CACHE_MISSES)
+               << "; branch misses / 1k instructions: " << a.counters().perKiloInstruction(HardwareEvent::BRANCH_MISSES) << "; " << std::endl;
+        }
+        if (base)
+        {
+          info << "Variance from base: " << std::abs(base->averageResult() - a.averageResult()) << "; " << std::endl;
+        }
+        if (base && base != &a && base->medianTime() > 0)
+        {
+          const auto p = mannWhitneyU(a.times(), base->times());
+          info << "Median time vs base: " << a.medianTime() / base->medianTime() << "x, p = " << p
+               << (p < significance ? " (significant)" : " (not significant)") << "; " << std::endl;
+        }
         info << "====================================================================================" << std::endl;
       }
 
       std::cout << info.str();
     }
 
+
+    /*!
+      * \brief Writes one CSV row per algorithm (with a header), prefixed by the environment columns
+      *
+      * \param out - the destination stream
+      */
+    void writeCsv(std::ostream& out) const;
+
+
+    /*!
+      * \brief Writes the environment and every algorithm's statistics as a JSON document
+      *
+      * \param out - the destination stream
+      */
+    void writeJson(std::ostream& out) const;
+
+
+    /*!
+      * \brief Compares the results against a CSV previously produced by writeCsv.
+      *
+      * Algorithms are matched by name; the ones missing from either run are ignored.
+      * A metric regresses when it degrades beyond its threshold and the per run samples of both runs
+      * differ significantly (Mann-Whitney), so the noise of a rerun is not reported.
+      * The samples of one run share its machine state, so a drift between processes (frequency scaling, other load)
+      * is not noise to the test: RegressionThresholds::time should exceed the run to run variation of the machine.
+      * \param previousCsv - the previous results
+      * \param error - set to the reason when the previous results cannot be read
+      * \param thresholds - the tolerated degradation
+      *
+      * \return the regressions found, empty if none; nothing if the previous results are malformed
+      */
+    std::optional<std::vector<Regression>> compare(std::istream& previousCsv, std::string& error, const RegressionThresholds& thresholds = RegressionThresholds()) const;
+
   protected:
     std::list<AlgorithmStatistics> table;
     const AlgorithmStatistics* base = nullptr;
   };
 
-  template <class Function, class... Args>
-  Benchmark::AlgorithmStatistics::AlgorithmStatistics(size_t iterations, const char* name, bool isBase, Function algorithm, Args... algorithmArguments):
+  template <class Function>
+  Benchmark::AlgorithmStatistics::AlgorithmStatistics(const BenchmarkOptions& options, size_t iterations, const char* name, bool isBase, Function algorithm) :
     AlgorithmStatistics()
   {
-    _base = isBase;
-    _name = name;
-    _iterations = iterations;
-    double result = 0;
-    double time = 0;
-    FOR(i, iterations)
-    {           
-      auto crtTime = clock(
-        [&result, &algorithm , &algorithmArguments...]()
-        {
-          result += algorithm(std::forward(algorithmArguments...));
-        }
-      ); 
-      if (crtTime < _bestTime)
-      {
-        _bestTime = crtTime;
-      }
-      if(crtTime > _worstTime)
-      { 
-        _worstTime = crtTime;
-      }
+    Repetitions<Function> repetitions(options, algorithm);
+    repetitions.warmup();
 
-      time += crtTime;
+    std::vector<RepetitionSample> samples(iterations);
+    for (auto& sample : samples)
+    {
+      sample = repetitions.run();
     }
 
-    _timeMillis = time / iterations;
-    _averageResult = result / iterations;
+    *this = AlgorithmStatistics(options, name, isBase, Repetitions<Function>::observed, samples);
   }
-  template <class Function>
-  Benchmark::AlgorithmStatistics::AlgorithmStatistics(size_t iterations, const char* name, bool isBase, Function algorithm):
+
+  Benchmark::AlgorithmStatistics::AlgorithmStatistics(const BenchmarkOptions& options, const char* name, bool isBase, bool observed, const std::vector<RepetitionSample>& samples) :
     AlgorithmStatistics()
   {
     _base = isBase;
     _name = name;
-    _iterations = iterations;
-    double result = 0;
-    double time = 0;
-    FOR(i, iterations)
+    _iterations = samples.size();
+    _observed = observed;
+
+    if (samples.empty())
     {
-      auto crtTime = clock(
-        [&result, &algorithm]()
-        {
-          result += algorithm();
-        }
-      );
-      if (crtTime < _bestTime)
+      return;
+    }
+
+    std::vector<double> timesToTarget;
+    auto area = 0.0;
+
+    _times.reserve(samples.size());
+    _results.reserve(samples.size());
+    _counters = samples.front().counters;
+    for (auto& sample : samples)
+    {
+      _bestTime = std::min(_bestTime, sample.timeMillis);
+      _worstTime = std::max(_worstTime, sample.timeMillis);
+      _times.push_back(sample.timeMillis);
+      _results.push_back(sample.result);
+      if (&sample != &samples.front())
       {
-        _bestTime = crtTime;
+        _counters += sample.counters;
       }
-      if (crtTime > _worstTime)
+
+      area += sample.areaUnderCurve;
+      if (std::isfinite(sample.timeToTarget))
       {
-        _worstTime = crtTime;
+        timesToTarget.push_back(sample.timeToTarget);
       }
+    }
 
-      time += crtTime;
+    _averageResult = mean(_results);
+    if (observed)
+    {
+      _areaUnderCurve = area / samples.size();
+      _targetHitRate = static_cast<double>(timesToTarget.size()) / samples.size();
+      if (!timesToTarget.empty())
+      {
+        std::sort(timesToTarget.begin(), timesToTarget.end());
+        _timeToTarget = percentile(timesToTarget, 0.5);
+      }
     }
 
-    _timeMillis = time / iterations;
-    _averageResult = result / iterations;
+    // _times is left sorted, without the outliers
+    _outliers = rejectOutliers(_times, options.outlierFactor);
+    _timeMillis = mean(_times);
+    _medianTime = percentile(_times, 0.5);
+    _p90Time = percentile(_times, 0.9);
+    _p99Time = percentile(_times, 0.99);
+    _standardDeviation = statistics::standardDeviation(_times);
+    _meanInterval = bootstrapMean(_times, options.bootstrapResamples, options.confidence);
+    _medianInterval = bootstrapMedian(_times, options.bootstrapResamples, options.confidence);
+  }
+
+  template <class Function, class... Args>
+  Benchmark::AlgorithmStatistics::AlgorithmStatistics(size_t iterations, const char* name, bool isBase, Function algorithm, Args... algorithmArguments):
+    AlgorithmStatistics(BenchmarkOptions(), iterations, name, isBase,
+      [algorithm, algorithmArguments...]()
+      {
+        return algorithm(algorithmArguments...);
+      }
+    )
+  {
+    ;
+  }
+
+  template <class Function>
+  Benchmark::AlgorithmStatistics::AlgorithmStatistics(size_t iterations, const char* name, bool isBase, Function algorithm):
+    AlgorithmStatistics(BenchmarkOptions(), iterations, name, isBase, algorithm)
+  {
+    ;
   }
 }
 
 #endif // !__BENCHMARK_H__
-
@@ -0,0 +1,150 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: runs the benchmark repetitions on pinned worker threads
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __BENCHMARK_RUNNER_H__
+#define __BENCHMARK_RUNNER_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "../utility/Affinity.h"
+#include "../random_generators/vectorGenerator.h"
+#include "benchmark.h"
+
+namespace statistics
+{
+  /*!
+    * \brief How the repetitions are scheduled
+    * \ingroup statistics
+    */
+  enum class ExecutionMode
+  {
+    SERIAL,/*!< one pinned worker: nothing competes for the core, caches or memory bandwidth - use it for timings */
+    PARALLEL/*!< one pinned worker per physical core - use it for quality only benchmarks (e.g. tour lengths); the timings are contended */
+  };
+
+
+  /*! \class RunnerOptions "benchmarkRunner.h"
+    * \brief How BenchmarkRunner distributes the repetitions.
+    * \ingroup statistics
+    */
+  struct RunnerOptions
+  {
+    ExecutionMode mode = ExecutionMode::PARALLEL;/*!< serial or parallel repetitions */
+    size_t threads = 0;/*!< the workers in PARALLEL mode; 0 means one per physical core */
+    bool pin = true;/*!< pin every worker to its own physical core */
+    std::optional<uint64_t> seed;/*!< the base seed of the repetitions; randomGenerators::DefaultRandomEngine::seed() when not set */
+  };
+
+
+  /*! \class BenchmarkRunner "benchmarkRunner.h"
+    * \brief Runs the repetitions of an algorithm on worker threads and collects them into AlgorithmStatistics.
+    *
+    * Every repetition reseeds the worker's DefaultRandomEngine with repetitionSeed(repetition), so a
+    * repetition draws the same numbers whichever worker runs it and however many workers there are:
+    * the results are reproducible from the base seed. The workers take the repetitions from a shared
+    * counter and write them into their slot, so the samples keep the repetition order.
+    * \ingroup statistics
+    */
+  class BenchmarkRunner
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param options - the scheduling options
+      */
+    explicit BenchmarkRunner(const RunnerOptions& options = RunnerOptions()) :
+      _options(options)
+    , _processors(utility::physicalCoreProcessors())
+    , _seed(options.seed ? *options.seed : randomGenerators::DefaultRandomEngine::seed())
+    {
+      ;
+    }
+
+    //! the number of workers used for a run
+    size_t workers() const
+    {
+      if (_options.mode == ExecutionMode::SERIAL)
+      {
+        return 1;
+      }
+
+      return _options.threads ? _options.threads : _processors.size();
+    }
+
+    //! the seed of a repetition
+    uint64_t repetitionSeed(size_t repetition) const
+    {
+      return randomGenerators::mixSeed(_seed, repetition);
+    }
+
+    /*!
+      * \brief Runs and measures the algorithm.
+      *
+      * Every worker runs the BenchmarkOptions::warmup runs on its own copy of the algorithm first.
+      * \tparam Function - the algorithm: double() or double(ConvergenceRecorder&); copied once per worker
+      *
+      * \param options - how the algorithm is measured
+      * \param iterations - the number of repetitions
+      * \param name - the name of the algorithm
+      * \param isBase - this is the base algorithm (there can be only one)
+      * \param algorithm - the algorithm
+      *
+      * \return the statistics of the repetitions
+      */
+    template <class Function>
+    Benchmark::AlgorithmStatistics run(const BenchmarkOptions& options, size_t iterations, const char* name, bool isBase, Function algorithm) const
+    {
+      std::vector<RepetitionSample> samples(iterations);
+      std::atomic<size_t> next(0);
+
+      const auto worker = [&](size_t index)
+      {
+        // pinning is best effort: an unpinned worker still produces valid samples
+        if (_options.pin)
+        {
+          utility::pinCurrentThread(_processors[index % _processors.size()]);
+        }
+
+        auto local = algorithm;
+        Repetitions<Function> repetitions(options, local);
+        repetitions.warmup();
+
+        for (auto repetition = next.fetch_add(1); repetition < iterations; repetition = next.fetch_add(1))
+        {
+          randomGenerators::DefaultRandomEngine::reseedThread(repetitionSeed(repetition));
+          samples[repetition] = repetitions.run();
+        }
+      };
+
+      // even the serial worker gets its own thread, so the caller's affinity is left alone
+      std::vector<std::thread> threads;
+      const auto count = std::max<size_t>(1, std::min(workers(), iterations));
+      threads.reserve(count);
+      FOR(w, count)
+      {
+        threads.emplace_back(worker, w);
+      }
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+
+      return Benchmark::AlgorithmStatistics(options, name, isBase, Repetitions<Function>::observed, samples);
+    }
+
+  protected:
+    RunnerOptions _options;
+    std::vector<size_t> _processors;
+    uint64_t _seed;
+  };
+}
+
+#endif // !__BENCHMARK_RUNNER_H__
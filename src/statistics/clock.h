@@ -8,11 +8,80 @@
 #define __CLOCK_H__
 
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 
+#include "perfCounters.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define STATISTICS_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STATISTICS_HAS_TSC 1
+#else
+#define STATISTICS_HAS_TSC 0
+#endif
+
 /*! \defgroup statistics statistics - module for application performance monitors */
 namespace statistics
 {
+  /*!
+    * \brief The time source used for measurements
+    * \ingroup statistics
+    */
+  enum class TimeSource
+  {
+    STEADY_CLOCK,/*!< std::chrono::steady_clock - monotonic, portable */
+    TSC/*!< the CPU time stamp counter - lowest overhead; needs an invariant TSC, falls back to STEADY_CLOCK where unavailable */
+  };
+
+
+  /*!
+    * \brief Reads the time stamp counter.
+    *
+    * \return the current TSC value, 0 if the platform has none
+    * \ingroup statistics
+    */
+  inline uint64_t readTimeStampCounter()
+  {
+#if STATISTICS_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+  }
+
+
+  /*!
+    * \brief Number of TSC ticks per millisecond, calibrated once against steady_clock.
+    *
+    * \return the tick rate, 0 if the platform has no TSC
+    * \ingroup statistics
+    */
+  inline double tscTicksPerMillisecond()
+  {
+    static const double ticksPerMillisecond = []()
+    {
+      if (!STATISTICS_HAS_TSC)
+      {
+        return 0.0;
+      }
+
+      const auto start = std::chrono::steady_clock::now();
+      const auto startTicks = readTimeStampCounter();
+      while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(20))
+      {
+        ;
+      }
+      const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+      return (readTimeStampCounter() - startTicks) / elapsed.count();
+    }();
+
+    return ticksPerMillisecond;
+  }
+
 
   /*!
     * \brief Function to measure the time needed to perform a function
@@ -20,24 +89,59 @@ namespace statistics
     * \tparam FunctionType - type of the function to be timed
     *
     * \param function - pointer to the function to be timed
+    * \param source - the time source
     *
     * \return the time (in milliseconds) needed to perform the function
     * \ingroup statistics
     */
   template<typename FunctionType>
-  double clock(FunctionType function)
+  double clock(FunctionType function, TimeSource source = TimeSource::STEADY_CLOCK)
   {
-    auto start = std::chrono::system_clock::now();
+    if (source == TimeSource::TSC && tscTicksPerMillisecond() > 0)
+    {
+      const auto ticksPerMillisecond = tscTicksPerMillisecond();
+      const auto start = readTimeStampCounter();
+
+      function();
+
+      return (readTimeStampCounter() - start) / ticksPerMillisecond;
+    }
+
+    auto start = std::chrono::steady_clock::now();
 
     function();
 
-    auto end = std::chrono::system_clock::now();
-    std::chrono::duration<double> time = end - start;
+    auto end = std::chrono::steady_clock::now();
+    std::chrono::duration<double, std::milli> time = end - start;
 
-    return time.count() * 1000;
+    return time.count();
   };
 
 
+  /*!
+    * \brief Function to measure the time and the hardware events needed to perform a function
+    *
+    * \tparam FunctionType - type of the function to be timed
+    *
+    * \param[in] function - pointer to the function to be timed
+    * \param[in] counters - the opened counters (see PerfCounters::available)
+    * \param[out] measured - the hardware events counted while the function ran
+    * \param[in] source - the time source
+    *
+    * \return the time (in milliseconds) needed to perform the function
+    * \ingroup statistics
+    */
+  template<typename FunctionType>
+  double clock(FunctionType function, PerfCounters& counters, HardwareCounters& measured, TimeSource source = TimeSource::STEADY_CLOCK)
+  {
+    counters.start();
+    auto t = clock(function, source);
+    measured = counters.stop();
+
+    return t;
+  }
+
+
   /*!
     * \brief Utility function to measure the time needed to perform a task.
     * This variant has an added echo to cout
@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <limits>
+
+#include "convergence.h"
+
+statistics::ConvergenceRecorder::ConvergenceRecorder(size_t capacity)
+{
+  _points.reserve(std::max<size_t>(capacity, 1));
+  start();
+}
+
+void statistics::ConvergenceRecorder::start()
+{
+  _points.clear();
+  _truncated = 0;
+  _start = std::chrono::steady_clock::now();
+}
+
+double statistics::ConvergenceRecorder::timeToTarget(double target, bool minimize) const
+{
+  for (auto& point : _points)
+  {
+    if (minimize ? point.cost <= target : point.cost >= target)
+    {
+      return point.timeMillis;
+    }
+  }
+
+  return std::numeric_limits<double>::infinity();
+}
+
+double statistics::ConvergenceRecorder::areaUnderCurve(double horizonMillis) const
+{
+  if (_points.empty())
+  {
+    return 0;
+  }
+
+  const auto horizon = horizonMillis > 0 ? horizonMillis : _points.back().timeMillis;
+  if (horizon <= 0)
+  {
+    return _points.back().cost;
+  }
+
+  // the best cost is a step function: each point holds until the next one
+  auto area = 0.0;
+  auto previousTime = 0.0;
+  auto previousCost = _points.front().cost;
+  for (auto& point : _points)
+  {
+    const auto time = std::min(point.timeMillis, horizon);
+    area += (time - previousTime) * previousCost;
+    previousTime = time;
+    previousCost = point.cost;
+  }
+  area += (horizon - previousTime) * previousCost;
+
+  return area / horizon;
+}
@@ -0,0 +1,121 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: anytime behaviour of the algorithms - best cost found as a function of time
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __CONVERGENCE_H__
+#define __CONVERGENCE_H__
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+namespace statistics
+{
+  /*! \class NullObserver "convergence.h"
+    * \brief The default convergence observer of the algorithms: ignores everything and compiles away.
+    *
+    * An observer is anything with an improved(size_t iteration, double cost) member; the algorithms
+    * call it every time they accept a better cost.
+    * \ingroup statistics
+    */
+  struct NullObserver
+  {
+    //! ignored
+    void improved(size_t, double) const
+    {
+      ;
+    }
+  };
+
+
+  /*! \class ConvergencePoint "convergence.h"
+    * \brief An improvement of the best cost.
+    * \ingroup statistics
+    */
+  struct ConvergencePoint
+  {
+    double timeMillis = 0;/*!< time since ConvergenceRecorder::start */
+    size_t iteration = 0;/*!< the iteration of the algorithm */
+    double cost = 0;/*!< the new best cost */
+  };
+
+
+  /*! \class ConvergenceRecorder "convergence.h"
+    * \brief Convergence observer recording the improvements into a preallocated buffer.
+    *
+    * improved() never allocates: once the buffer is full the last point is overwritten, so the
+    * final best cost is always kept (and truncated() tells how many points were lost).
+    * Reporting a cost equal to the last one is ignored.
+    * \ingroup statistics
+    */
+  class ConvergenceRecorder
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param capacity - the number of improvements that can be recorded
+      */
+    explicit ConvergenceRecorder(size_t capacity = 4096);
+
+    //! forgets the previous run and starts the clock
+    void start();
+
+    /*!
+      * \brief Records an improvement
+      * \param iteration - the iteration of the algorithm
+      * \param cost - the new best cost
+      */
+    void improved(size_t iteration, double cost)
+    {
+      if (!_points.empty() && _points.back().cost == cost)
+      {
+        return;
+      }
+
+      const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - _start;
+      if (_points.size() == _points.capacity())
+      {
+        _points.back() = { elapsed.count(), iteration, cost };
+        ++_truncated;
+        return;
+      }
+
+      _points.push_back({ elapsed.count(), iteration, cost });
+    }
+
+    //! the recorded improvements, in time order
+    const std::vector<ConvergencePoint>& points() const { return _points; }
+
+    //! the number of improvements that did not fit the buffer
+    size_t truncated() const { return _truncated; }
+
+    /*!
+      * \brief The time when the best cost first reached the target
+      * \param target - the target cost
+      * \param minimize - lower costs are better
+      *
+      * \return the time in milliseconds, infinity if the target was never reached
+      */
+    double timeToTarget(double target, bool minimize) const;
+
+    /*!
+      * \brief The best cost averaged over [0, horizonMillis]: the area under the convergence curve divided by the horizon.
+      *
+      * Lower is better for minimization; the best cost is assumed to be the first recorded one until
+      * it was recorded, and the last one after the run ended.
+      * \param horizonMillis - the time horizon; 0 means up to the last improvement
+      *
+      * \return the time averaged best cost, 0 if nothing was recorded
+      */
+    double areaUnderCurve(double horizonMillis) const;
+
+  protected:
+    std::vector<ConvergencePoint> _points;
+    std::chrono::steady_clock::time_point _start;
+    size_t _truncated = 0;
+  };
+}
+
+#endif // !__CONVERGENCE_H__
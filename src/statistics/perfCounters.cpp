@@ -0,0 +1,133 @@
+#include "perfCounters.h"
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+  const uint64_t EVENT_CONFIGS[] = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+    PERF_COUNT_HW_BRANCH_MISSES,
+  };
+
+  int openEvent(uint64_t config)
+  {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.type = PERF_TYPE_HARDWARE;
+    attributes.size = sizeof(attributes);
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // this thread, any CPU, no group
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+  }
+}
+
+statistics::PerfCounters::PerfCounters()
+{
+  for (std::size_t e = 0; e < _descriptors.size(); ++e)
+  {
+    _descriptors[e] = openEvent(EVENT_CONFIGS[e]);
+  }
+}
+
+statistics::PerfCounters::~PerfCounters()
+{
+  for (auto descriptor : _descriptors)
+  {
+    if (descriptor >= 0)
+    {
+      close(descriptor);
+    }
+  }
+}
+
+bool statistics::PerfCounters::available() const
+{
+  for (auto descriptor : _descriptors)
+  {
+    if (descriptor >= 0)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+void statistics::PerfCounters::start()
+{
+  for (auto descriptor : _descriptors)
+  {
+    if (descriptor >= 0)
+    {
+      ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+      ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+}
+
+statistics::HardwareCounters statistics::PerfCounters::stop()
+{
+  for (auto descriptor : _descriptors)
+  {
+    if (descriptor >= 0)
+    {
+      ioctl(descriptor, PERF_EVENT_IOC_DISABLE, 0);
+    }
+  }
+
+  HardwareCounters counters;
+  for (std::size_t e = 0; e < _descriptors.size(); ++e)
+  {
+    // value, time enabled, time running
+    uint64_t data[3] = {};
+    if (_descriptors[e] < 0 || read(_descriptors[e], data, sizeof(data)) != sizeof(data) || !data[2])
+    {
+      continue;
+    }
+
+    counters.values[e] = data[2] < data[1] ? static_cast<uint64_t>(static_cast<double>(data[0]) * data[1] / data[2]) : data[0];
+    counters.available |= 1u << e;
+  }
+
+  return counters;
+}
+
+#else
+
+statistics::PerfCounters::PerfCounters()
+{
+  _descriptors.fill(-1);
+}
+
+statistics::PerfCounters::~PerfCounters()
+{
+  ;
+}
+
+bool statistics::PerfCounters::available() const
+{
+  return false;
+}
+
+void statistics::PerfCounters::start()
+{
+  ;
+}
+
+statistics::HardwareCounters statistics::PerfCounters::stop()
+{
+  return HardwareCounters();
+}
+
+#endif
@@ -0,0 +1,110 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: hardware performance counters (cycles, instructions, cache and branch misses)
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __PERF_COUNTERS_H__
+#define __PERF_COUNTERS_H__
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace statistics
+{
+  /*!
+    * \brief The hardware events that can be counted
+    * \ingroup statistics
+    */
+  enum class HardwareEvent
+  {
+    CYCLES = 0,/*!< CPU cycles */
+    INSTRUCTIONS,/*!< retired instructions */
+    CACHE_MISSES,/*!< last level cache misses */
+    BRANCH_MISSES,/*!< mispredicted branches */
+    COUNT/*!< the number of events */
+  };
+
+
+  /*! \class HardwareCounters "perfCounters.h"
+    * \brief Values of the hardware events over a measured region.
+    * \ingroup statistics
+    */
+  struct HardwareCounters
+  {
+    std::array<uint64_t, static_cast<std::size_t>(HardwareEvent::COUNT)> values = {};/*!< the counts, indexed by HardwareEvent */
+    unsigned available = 0;/*!< bit i is set when HardwareEvent i was counted */
+
+    //! tells whether the event was counted
+    bool has(HardwareEvent event) const { return available & (1u << static_cast<unsigned>(event)); }
+
+    //! the count of the event (0 when it was not counted)
+    uint64_t operator[](HardwareEvent event) const { return values[static_cast<std::size_t>(event)]; }
+
+    //! instructions per cycle; 0 when either was not counted
+    double ipc() const
+    {
+      return has(HardwareEvent::CYCLES) && has(HardwareEvent::INSTRUCTIONS) && (*this)[HardwareEvent::CYCLES] ?
+        static_cast<double>((*this)[HardwareEvent::INSTRUCTIONS]) / (*this)[HardwareEvent::CYCLES] : 0;
+    }
+
+    //! the event count per thousand instructions; 0 when either was not counted
+    double perKiloInstruction(HardwareEvent event) const
+    {
+      return has(event) && has(HardwareEvent::INSTRUCTIONS) && (*this)[HardwareEvent::INSTRUCTIONS] ?
+        1000.0 * (*this)[event] / (*this)[HardwareEvent::INSTRUCTIONS] : 0;
+    }
+
+    //! accumulates another measurement; only the events counted by both stay available
+    HardwareCounters& operator+=(const HardwareCounters& other)
+    {
+      for (std::size_t e = 0; e < values.size(); ++e)
+      {
+        values[e] += other.values[e];
+      }
+      available &= other.available;
+      return *this;
+    }
+  };
+
+
+  /*! \class PerfCounters "perfCounters.h"
+    * \brief Counts hardware events of the calling thread.
+    *
+    * Uses perf_event_open on Linux. Every event is opened on its own, so the ones the
+    * kernel, the CPU or the virtual machine refuse are simply reported as unavailable;
+    * on other platforms (or with perf disabled) nothing is available and the measurements are empty.
+    * Counts are scaled when the kernel multiplexes the counters.
+    * \ingroup statistics
+    */
+  class PerfCounters
+  {
+  public:
+    //! opens the counters
+    PerfCounters();
+
+    //! closes the counters
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    //! tells whether at least one event can be counted
+    bool available() const;
+
+    //! resets and starts the counters
+    void start();
+
+    /*!
+      * \brief Stops the counters
+      * \return the counts since start()
+      */
+    HardwareCounters stop();
+
+  protected:
+    std::array<int, static_cast<std::size_t>(HardwareEvent::COUNT)> _descriptors;
+  };
+}
+
+#endif // !__PERF_COUNTERS_H__
@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+#include "sampleStatistics.h"
+
+namespace
+{
+  template <class Statistic>
+  statistics::ConfidenceInterval bootstrap(const std::vector<double>& samples, size_t resamples, double confidence, uint64_t seed, Statistic statistic)
+  {
+    if (!resamples)
+    {
+      return {};
+    }
+
+    std::mt19937_64 engine(seed);
+    std::uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+
+    std::vector<double> resample(samples.size());
+    std::vector<double> estimates(resamples);
+    for (auto& estimate : estimates)
+    {
+      for (auto& value : resample)
+      {
+        value = samples[pick(engine)];
+      }
+      estimate = statistic(resample);
+    }
+
+    std::sort(estimates.begin(), estimates.end());
+    const auto alpha = (1 - confidence) / 2;
+    return { statistics::percentile(estimates, alpha), statistics::percentile(estimates, 1 - alpha) };
+  }
+}
+
+double statistics::percentile(const std::vector<double>& sorted, double p)
+{
+  const auto rank = p * (sorted.size() - 1);
+  const auto low = static_cast<size_t>(std::floor(rank));
+  const auto high = std::min(low + 1, sorted.size() - 1);
+
+  return sorted[low] + (rank - low) * (sorted[high] - sorted[low]);
+}
+
+double statistics::mean(const std::vector<double>& samples)
+{
+  return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+double statistics::standardDeviation(const std::vector<double>& samples)
+{
+  if (samples.size() < 2)
+  {
+    return 0;
+  }
+
+  const auto m = mean(samples);
+  auto sum = 0.0;
+  for (auto s : samples)
+  {
+    sum += (s - m) * (s - m);
+  }
+
+  return std::sqrt(sum / (samples.size() - 1));
+}
+
+size_t statistics::rejectOutliers(std::vector<double>& samples, double k)
+{
+  std::sort(samples.begin(), samples.end());
+  if (k <= 0 || samples.size() < 4)
+  {
+    return 0;
+  }
+
+  const auto q1 = percentile(samples, 0.25);
+  const auto q3 = percentile(samples, 0.75);
+  const auto low = q1 - k * (q3 - q1);
+  const auto high = q3 + k * (q3 - q1);
+
+  const auto before = samples.size();
+  samples.erase(std::upper_bound(samples.begin(), samples.end(), high), samples.end());
+  samples.erase(samples.begin(), std::lower_bound(samples.begin(), samples.end(), low));
+
+  return before - samples.size();
+}
+
+statistics::ConfidenceInterval statistics::bootstrapMean(const std::vector<double>& samples, size_t resamples, double confidence, uint64_t seed)
+{
+  return bootstrap(samples, resamples, confidence, seed, [](const std::vector<double>& resample) { return mean(resample); });
+}
+
+statistics::ConfidenceInterval statistics::bootstrapMedian(const std::vector<double>& samples, size_t resamples, double confidence, uint64_t seed)
+{
+  return bootstrap(samples, resamples, confidence, seed,
+    [](std::vector<double>& resample)
+    {
+      const auto middle = resample.begin() + resample.size() / 2;
+      std::nth_element(resample.begin(), middle, resample.end());
+      if (resample.size() % 2)
+      {
+        return *middle;
+      }
+      return (*middle + *std::max_element(resample.begin(), middle)) / 2;
+    }
+  );
+}
+
+double statistics::mannWhitneyU(const std::vector<double>& a, const std::vector<double>& b)
+{
+  const auto n1 = static_cast<double>(a.size());
+  const auto n2 = static_cast<double>(b.size());
+  if (a.empty() || b.empty())
+  {
+    return 1;
+  }
+
+  // rank the pooled samples; ties get the average of their ranks
+  struct Ranked
+  {
+    double value;
+    bool first;
+  };
+  std::vector<Ranked> pooled;
+  pooled.reserve(a.size() + b.size());
+  for (auto v : a) pooled.push_back({ v, true });
+  for (auto v : b) pooled.push_back({ v, false });
+  std::sort(pooled.begin(), pooled.end(), [](const Ranked& l, const Ranked& r) { return l.value < r.value; });
+
+  const auto n = n1 + n2;
+  auto rankSumA = 0.0;
+  auto tieCorrection = 0.0;
+  for (size_t i = 0; i < pooled.size();)
+  {
+    auto j = i;
+    while (j < pooled.size() && pooled[j].value == pooled[i].value)
+    {
+      ++j;
+    }
+
+    const auto averageRank = (i + 1 + j) / 2.0;
+    for (auto k = i; k < j; ++k)
+    {
+      rankSumA += pooled[k].first ? averageRank : 0;
+    }
+
+    const auto t = static_cast<double>(j - i);
+    tieCorrection += t * t * t - t;
+    i = j;
+  }
+
+  const auto u = rankSumA - n1 * (n1 + 1) / 2;
+  const auto mu = n1 * n2 / 2;
+  const auto sigma = std::sqrt(n1 * n2 / 12 * ((n + 1) - tieCorrection / (n * (n - 1))));
+  if (sigma == 0)
+  {
+    return 1;
+  }
+
+  const auto z = std::max(0.0, std::abs(u - mu) - 0.5) / sigma;
+  return std::erfc(z / std::sqrt(2.0));
+}
@@ -0,0 +1,107 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: descriptive statistics, bootstrap confidence intervals and significance tests for samples
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __SAMPLE_STATISTICS_H__
+#define __SAMPLE_STATISTICS_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace statistics
+{
+  /*! \class ConfidenceInterval "sampleStatistics.h"
+    * \brief A two sided confidence interval.
+    * \ingroup statistics
+    */
+  struct ConfidenceInterval
+  {
+    double low = 0;/*!< lower bound */
+    double high = 0;/*!< upper bound */
+  };
+
+  /*!
+    * \brief Percentile of sorted samples (linear interpolation between the closest ranks).
+    *
+    * \param sorted - the samples, sorted ascending; must not be empty
+    * \param p - the percentile, in [0, 1]
+    *
+    * \return the percentile
+    * \ingroup statistics
+    */
+  double percentile(const std::vector<double>& sorted, double p);
+
+  /*!
+    * \brief Arithmetic mean of the samples.
+    *
+    * \param samples - the samples; must not be empty
+    *
+    * \return the mean
+    * \ingroup statistics
+    */
+  double mean(const std::vector<double>& samples);
+
+  /*!
+    * \brief Sample standard deviation (n - 1 denominator).
+    *
+    * \param samples - the samples
+    *
+    * \return the standard deviation, 0 for fewer than 2 samples
+    * \ingroup statistics
+    */
+  double standardDeviation(const std::vector<double>& samples);
+
+  /*!
+    * \brief Removes the samples outside Tukey's fences [Q1 - k * IQR, Q3 + k * IQR].
+    *
+    * \param[in,out] samples - the samples; the survivors are returned sorted
+    * \param[in] k - the fence factor (1.5 is the usual choice); 0 or less keeps everything
+    *
+    * \return the number of samples removed
+    * \ingroup statistics
+    */
+  size_t rejectOutliers(std::vector<double>& samples, double k);
+
+  /*!
+    * \brief Percentile bootstrap confidence interval of the mean.
+    *
+    * \param samples - the samples; must not be empty
+    * \param resamples - the number of bootstrap resamples; 0 skips the bootstrap
+    * \param confidence - the confidence level, e.g. 0.95
+    * \param seed - the seed of the resampling, so the interval is reproducible
+    *
+    * \return the confidence interval; [0, 0] without resamples
+    * \ingroup statistics
+    */
+  ConfidenceInterval bootstrapMean(const std::vector<double>& samples, size_t resamples, double confidence, uint64_t seed = 0x5eed);
+
+  /*!
+    * \brief Percentile bootstrap confidence interval of the median.
+    *
+    * \param samples - the samples; must not be empty
+    * \param resamples - the number of bootstrap resamples; 0 skips the bootstrap
+    * \param confidence - the confidence level, e.g. 0.95
+    * \param seed - the seed of the resampling, so the interval is reproducible
+    *
+    * \return the confidence interval; [0, 0] without resamples
+    * \ingroup statistics
+    */
+  ConfidenceInterval bootstrapMedian(const std::vector<double>& samples, size_t resamples, double confidence, uint64_t seed = 0x5eed);
+
+  /*!
+    * \brief Two sided Mann-Whitney U test (normal approximation, tie and continuity corrected).
+    *
+    * Non-parametric: no normality assumption, which suits skewed timing distributions.
+    * \param a - the first set of samples
+    * \param b - the second set of samples
+    *
+    * \return the p-value of "a and b come from the same distribution"; 1 if either set is empty
+    * \ingroup statistics
+    */
+  double mannWhitneyU(const std::vector<double>& a, const std::vector<double>& b);
+}
+
+#endif // !__SAMPLE_STATISTICS_H__
@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <ratio>
+
+#include "../utility/Defines.h"
+#include "trace.h"
+
+namespace
+{
+  // events per thread; a power of two, so the ring index is a mask
+  const size_t RING_CAPACITY = size_t(1) << 16;
+
+  /*
+    single producer (the owning thread) / single consumer (collect, under the registry lock) ring.
+    head and tail only grow; they live on separate cache lines so the producer and the consumer do not share one.
+  */
+  struct RingBuffer
+  {
+    std::array<statistics::trace::Event, RING_CAPACITY> events;
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+    std::atomic<uint64_t> dropped{ 0 };
+    uint32_t thread = 0;
+  };
+
+  struct KeptEvent
+  {
+    uint32_t thread;
+    statistics::trace::Event event;
+  };
+
+  struct Registry
+  {
+    std::mutex mutex;
+    std::vector<std::string> zones;
+    // the registry co-owns the buffers, so the events of finished threads can still be collected
+    std::vector<std::shared_ptr<RingBuffer>> buffers;
+    std::vector<statistics::trace::ZoneStatistics> statistics;
+    std::vector<KeptEvent> kept;
+    uint64_t dropped = 0;
+  };
+
+  Registry& registry()
+  {
+    static Registry s_registry;
+    return s_registry;
+  }
+
+  RingBuffer& threadBuffer()
+  {
+    thread_local const std::shared_ptr<RingBuffer> buffer = []()
+    {
+      auto created = std::make_shared<RingBuffer>();
+      auto& r = registry();
+      std::lock_guard<std::mutex> lock(r.mutex);
+      created->thread = static_cast<uint32_t>(r.buffers.size());
+      r.buffers.push_back(created);
+      return created;
+    }();
+
+    return *buffer;
+  }
+
+  // must be called with the registry lock held
+  void collectLocked(Registry& r, bool keepEvents)
+  {
+    const auto ticksPerNanosecond = statistics::trace::ticksPerMillisecond() / 1e6;
+
+    r.statistics.resize(r.zones.size());
+    for (auto& buffer : r.buffers)
+    {
+      const auto tail = buffer->tail.load(std::memory_order_relaxed);
+      const auto head = buffer->head.load(std::memory_order_acquire);
+      for (auto i = tail; i < head; ++i)
+      {
+        const auto& event = buffer->events[i & (RING_CAPACITY - 1)];
+        auto& zone = r.statistics[event.zone];
+
+        const auto nanoseconds = (event.end - event.start) / ticksPerNanosecond;
+        const auto millis = nanoseconds / 1e6;
+        zone.minMillis = zone.count ? std::min(zone.minMillis, millis) : millis;
+        zone.maxMillis = zone.count ? std::max(zone.maxMillis, millis) : millis;
+        zone.totalMillis += millis;
+        ++zone.count;
+        ++zone.histogram[std::max<int>(std::bit_width(static_cast<uint64_t>(nanoseconds)), 1) - 1];
+
+        if (keepEvents)
+        {
+          r.kept.push_back({ buffer->thread, event });
+        }
+      }
+      buffer->tail.store(head, std::memory_order_release);
+      r.dropped += buffer->dropped.exchange(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+double statistics::trace::ZoneStatistics::percentileMillis(double p) const
+{
+  const auto target = p * count;
+  uint64_t cumulative = 0;
+  for (size_t b = 0; b < histogram.size(); ++b)
+  {
+    cumulative += histogram[b];
+    if (cumulative && cumulative >= target)
+    {
+      return std::min(std::ldexp(1.0, static_cast<int>(b) + 1) / 1e6, maxMillis);
+    }
+  }
+
+  return maxMillis;
+}
+
+uint32_t statistics::trace::registerZone(const char* name)
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+
+  const auto found = std::find(r.zones.begin(), r.zones.end(), name);
+  if (found != r.zones.end())
+  {
+    return static_cast<uint32_t>(found - r.zones.begin());
+  }
+
+  r.zones.push_back(name);
+  r.statistics.resize(r.zones.size());
+  r.statistics.back().name = name;
+  return static_cast<uint32_t>(r.zones.size() - 1);
+}
+
+double statistics::trace::ticksPerMillisecond()
+{
+#if STATISTICS_HAS_TSC
+  return tscTicksPerMillisecond();
+#else
+  using TicksPerMillisecond = std::ratio_divide<std::milli, std::chrono::steady_clock::period>;
+  return static_cast<double>(TicksPerMillisecond::num) / TicksPerMillisecond::den;
+#endif
+}
+
+void statistics::trace::record(const Event& event)
+{
+  auto& buffer = threadBuffer();
+
+  const auto head = buffer.head.load(std::memory_order_relaxed);
+  if (head - buffer.tail.load(std::memory_order_acquire) >= RING_CAPACITY)
+  {
+    buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  buffer.events[head & (RING_CAPACITY - 1)] = event;
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void statistics::trace::collect(bool keepEvents)
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  collectLocked(r, keepEvents);
+}
+
+std::vector<statistics::trace::ZoneStatistics> statistics::trace::zoneStatistics()
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  collectLocked(r, false);
+
+  std::vector<ZoneStatistics> executed;
+  for (auto& zone : r.statistics)
+  {
+    if (zone.count)
+    {
+      executed.push_back(zone);
+    }
+  }
+
+  return executed;
+}
+
+uint64_t statistics::trace::droppedEvents()
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  collectLocked(r, false);
+
+  return r.dropped;
+}
+
+void statistics::trace::printZones(std::ostream& out)
+{
+  const auto zones = zoneStatistics();
+
+  out << std::left << std::setw(40) << "Zone" << std::right
+      << std::setw(12) << "Count" << std::setw(14) << "Total ms" << std::setw(12) << "Mean ms"
+      << std::setw(12) << "Min ms" << std::setw(12) << "~p50 ms" << std::setw(12) << "~p99 ms" << std::setw(12) << "Max ms" << std::endl;
+  for (auto& zone : zones)
+  {
+    out << std::left << std::setw(40) << zone.name << std::right
+        << std::setw(12) << zone.count << std::setw(14) << zone.totalMillis << std::setw(12) << zone.totalMillis / zone.count
+        << std::setw(12) << zone.minMillis << std::setw(12) << zone.percentileMillis(0.5) << std::setw(12) << zone.percentileMillis(0.99)
+        << std::setw(12) << zone.maxMillis << std::endl;
+  }
+
+  if (const auto dropped = droppedEvents())
+  {
+    out << dropped << " events dropped (ring buffer full); call statistics::trace::collect more often" << std::endl;
+  }
+}
+
+void statistics::trace::writeChromeTrace(std::ostream& out)
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  collectLocked(r, true);
+
+  auto origin = std::numeric_limits<uint64_t>::max();
+  for (auto& kept : r.kept)
+  {
+    origin = std::min(origin, kept.event.start);
+  }
+  const auto ticksPerMicrosecond = ticksPerMillisecond() / 1000;
+
+  const auto precision = out.precision(3);
+  const auto flags = out.setf(std::ios::fixed, std::ios::floatfield);
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  auto first = true;
+  for (auto& kept : r.kept)
+  {
+    out << (first ? "\n" : ",\n");
+    first = false;
+
+    // zone names come from string literals in the code; they need no escaping
+    out << "  {\"name\": \"" << r.zones[kept.event.zone] << "\", \"ph\": \"X\", \"pid\": 0, \"tid\": " << kept.thread
+        << ", \"ts\": " << (kept.event.start - origin) / ticksPerMicrosecond
+        << ", \"dur\": " << (kept.event.end - kept.event.start) / ticksPerMicrosecond << "}";
+  }
+  out << "\n]}\n";
+  out.flags(flags);
+  out.precision(precision);
+}
+
+void statistics::trace::reset()
+{
+  auto& r = registry();
+  std::lock_guard<std::mutex> lock(r.mutex);
+  collectLocked(r, false);
+
+  r.statistics.assign(r.zones.size(), ZoneStatistics());
+  for (size_t z = 0; z < r.zones.size(); ++z)
+  {
+    r.statistics[z].name = r.zones[z];
+  }
+  r.kept.clear();
+  r.dropped = 0;
+}
@@ -0,0 +1,203 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: low overhead named zones for profiling the algorithms' hot paths
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include <array>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "clock.h"
+
+/*!
+  * \brief Opens a named zone lasting until the end of the enclosing scope.
+  *
+  * Compiled out entirely unless STATISTICS_TRACE is defined, so it can stay in the hot loops.
+  * \param name - a string literal naming the zone
+  * \ingroup statistics
+  */
+#if defined(STATISTICS_TRACE)
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_ZONE(name)                                                                                                      \
+  static const uint32_t TRACE_CONCAT(traceZone_, __LINE__) = ::statistics::trace::registerZone(name);                         \
+  const ::statistics::trace::Scope TRACE_CONCAT(traceScope_, __LINE__)(TRACE_CONCAT(traceZone_, __LINE__))
+#else
+#define TRACE_ZONE(name) ((void)0)
+#endif
+
+namespace statistics
+{
+  namespace trace
+  {
+    /*! \class Event "trace.h"
+      * \brief One execution of a zone, in timestamp ticks (see ticksPerMillisecond).
+      * \ingroup statistics
+      */
+    struct Event
+    {
+      uint64_t start = 0;/*!< the timestamp when the zone was entered */
+      uint64_t end = 0;/*!< the timestamp when the zone was left */
+      uint32_t zone = 0;/*!< the zone id (see registerZone) */
+    };
+
+
+    /*! \class ZoneStatistics "trace.h"
+      * \brief The aggregated executions of a zone.
+      *
+      * histogram[b] counts the executions lasting [2^b, 2^(b+1)) nanoseconds (b = 0 also holds anything shorter).
+      * \ingroup statistics
+      */
+    struct ZoneStatistics
+    {
+      std::string name;/*!< the zone name */
+      uint64_t count = 0;/*!< the number of executions */
+      double totalMillis = 0;/*!< the time spent in the zone */
+      double minMillis = 0;/*!< the shortest execution */
+      double maxMillis = 0;/*!< the longest execution */
+      std::array<uint64_t, 64> histogram = {};/*!< log2 histogram of the durations in nanoseconds */
+
+      /*!
+        * \brief Estimates a percentile of the durations from the histogram (upper edge of the bucket)
+        * \param p - the percentile, in [0, 1]
+        * \return the estimated duration, in milliseconds
+        */
+      double percentileMillis(double p) const;
+    };
+
+
+    /*!
+      * \brief Registers a zone name; done once per TRACE_ZONE site.
+      * \param name - the zone name; zones with the same name are merged
+      * \return the zone id
+      * \ingroup statistics
+      */
+    uint32_t registerZone(const char* name);
+
+
+    /*!
+      * \brief The current timestamp (the TSC when available, steady_clock otherwise)
+      * \return the timestamp, in ticks
+      * \ingroup statistics
+      */
+    inline uint64_t now()
+    {
+#if STATISTICS_HAS_TSC
+      return readTimeStampCounter();
+#else
+      return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+
+    /*!
+      * \brief The rate of now()
+      * \return the ticks per millisecond
+      * \ingroup statistics
+      */
+    double ticksPerMillisecond();
+
+
+    /*!
+      * \brief Records a zone execution into the calling thread's ring buffer.
+      *
+      * Lock free and never blocking: when the buffer is full the event is dropped (and counted as such).
+      * \param event - the zone execution
+      * \ingroup statistics
+      */
+    void record(const Event& event);
+
+
+    /*! \class Scope "trace.h"
+      * \brief RAII zone: records the time between its construction and destruction. Used by TRACE_ZONE.
+      * \ingroup statistics
+      */
+    class Scope
+    {
+    public:
+      //! enters the zone
+      explicit Scope(uint32_t zone) :
+        _zone(zone)
+      , _start(now())
+      {
+        ;
+      }
+
+      //! leaves the zone
+      ~Scope()
+      {
+        record({ _start, now(), _zone });
+      }
+
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+
+    protected:
+      uint32_t _zone;
+      uint64_t _start;
+    };
+
+
+    /*!
+      * \brief Drains every thread's ring buffer into the aggregated statistics.
+      *
+      * May be called periodically (from any thread) to keep the ring buffers from overflowing;
+      * the other functions below collect first. Only collect(true) and writeChromeTrace keep the raw events,
+      * so querying the statistics does not grow the memory.
+      * \param keepEvents - also keep the raw events for writeChromeTrace
+      * \ingroup statistics
+      */
+    void collect(bool keepEvents = true);
+
+
+    /*!
+      * \brief The statistics of every zone that executed at least once
+      *
+      * The pending events are aggregated without being kept for writeChromeTrace.
+      * \return the per zone statistics
+      * \ingroup statistics
+      */
+    std::vector<ZoneStatistics> zoneStatistics();
+
+
+    /*!
+      * \brief The number of events dropped because a ring buffer was full
+      * \return the dropped events
+      * \ingroup statistics
+      */
+    uint64_t droppedEvents();
+
+
+    /*!
+      * \brief Prints a table of the zones: count, total, mean, min, p50, p99, max
+      * \param out - the destination stream
+      * \ingroup statistics
+      */
+    void printZones(std::ostream& out);
+
+
+    /*!
+      * \brief Writes the kept events in the Chrome trace event format (chrome://tracing, Perfetto)
+      *
+      * The events drained by collect(false), zoneStatistics, droppedEvents or printZones are only in the statistics.
+      * \param out - the destination stream
+      * \ingroup statistics
+      */
+    void writeChromeTrace(std::ostream& out);
+
+
+    /*!
+      * \brief Discards the pending and aggregated events (the zone names are kept)
+      * \ingroup statistics
+      */
+    void reset();
+  }
+}
+
+#endif // !__TRACE_H__
@@ -13,7 +13,7 @@ double stochastic::unitTest::adaptiveRandomSearchMin()
     BENCHMARK_ITERATIONS,
     BENCHMARK_PROBLEM_SIZE,
     stochastic::SearchSpace2D<double>(-5, 5),
-    [](const std::vector<double>& xi) {                                   // function to evaluate 
+    [](const auto& xi) {                                                  // function to evaluate (generic: a std::array position for small sizes)
       auto sum = 0.0;
       for (int i = 0; i < xi.size(); ++i)
       {
@@ -8,9 +8,19 @@
 #ifndef __ADAPTIVE_RANDOM_SEARCH_H__
 #define __ADAPTIVE_RANDOM_SEARCH_H__
 
+#include <algorithm>
+#include <array>
 #include <utility>
+#include <span>
+#include <type_traits>
+#include <vector>
 
 #include "../utility/Defines.h"
+#include "../utility/Concepts.h"
+#include "../utility/FixedDimension.h"
+#include "../utility/StoppingCriteria.h"
+#include "../statistics/trace.h"
+#include "../statistics/convergence.h"
 
 #include "RandomSearch.h"
 
@@ -20,17 +30,20 @@ namespace stochastic {
   /*!
     * \brief Takes a new step around the current position.
     * \tparam Type - the data type used by the algorithm
-    * \tparam Parameters - the position type
     * \tparam SearchSpace - the search space
     *
     * \param[in] step - the step to take
-    * \param[in] current - the current position
+    * \param[in] current - the current position (any contiguous range of Type converts to it)
     * \param[in] searchSpace - the search space
-    * \param[out] out - the new position
+    * \param[out] out - the new position; must have the size of current
+    * \param[in] distribution - the distribution of the step: uniform in (-step, step), or Gaussian / Cauchy / Levy
+    *                           with step as its scale (Levy flights: mostly small steps, now and then a very long one);
+    *                           integer positions always take uniform steps
     * \ingroup stochastic
     */
-  template <typename Type, TEMPLATE_TYPE_STD_VECTOR(Parameters), template<class> class SearchSpace>
-  void takeStep(Type step, const STD_VECTOR(Type, Parameters)& current, const SearchSpace<Type>& searchSpace, STD_VECTOR(Type, Parameters)& out)
+  template <typename Type, template<class> class SearchSpace>
+  void takeStep(Type step, std::type_identity_t<std::span<const Type>> current, const SearchSpace<Type>& searchSpace, std::type_identity_t<std::span<Type>> out,
+                randomGenerators::Distribution distribution = randomGenerators::Distribution::UNIFORM)
   {
     // will get a new position taking a random step ( rstep in (-step + current[d], step + current[d]) ) in each dimension.
 
@@ -38,24 +51,96 @@ namespace stochastic {
     const auto l = searchSpace.left();
     const auto r = searchSpace.right();
 
+    if constexpr (std::is_floating_point_v<Type>)
+    {
+      if (distribution != randomGenerators::Distribution::UNIFORM)
+      {
+        // the unbounded steps are drawn in bulk, the positions are clamped to the search space
+        randomGenerators::fillRandom<Type>(out, static_cast<Type>(0), step, distribution);
+        for (size_t d = 0; d < current.size(); ++d)
+        {
+          out[d] = std::clamp(current[d] + out[d], l, r);
+        }
+
+        return;
+      }
+    }
+
+    // the unit random numbers are drawn in bulk, then scaled to every dimension's interval
+    // (integers have no unit numbers between 0 and 1: they are drawn over the interval itself)
+    if constexpr (!std::is_integral_v<Type>)
+    {
+      randomGenerators::fillUniformRandom<Type>(out, static_cast<Type>(0), static_cast<Type>(1));
+    }
+
     // compute the new position.
-    for (auto& c : current)
+    for (size_t d = 0; d < current.size(); ++d)
     {
       // take care not to overflow the search space
-      const auto left = std::max(c - step, l);
-      const auto right = std::min(c + step, r);
+      const auto left = std::max(current[d] - step, l);
+      const auto right = std::min(current[d] + step, r);
 
-      // push back a random position component
-      auto number = randomGenerators::generateUniformDistributedRandomNumber(left, right);
-      out.push_back(number);
+      // a random position component
+      if constexpr (std::is_integral_v<Type>)
+      {
+        out[d] = randomGenerators::generateUniformDistributedRandomNumber(left, right);
+      }
+      else
+      {
+        out[d] = left + out[d] * (right - left);
+      }
     }
   }
 
+  /*!
+    * \brief Takes a new step around the current position, for a compile time problem size.
+    *
+    * The same step as above, the uniform one unrolled over the N dimensions with the position kept in
+    * registers; the other distributions use the loop above.
+    * \tparam Type - the data type used by the algorithm
+    * \tparam N - the problem size
+    * \tparam SearchSpace - the search space
+    *
+    * \param[in] step - the step to take
+    * \param[in] current - the current position
+    * \param[in] searchSpace - the search space
+    * \param[out] out - the new position
+    * \param[in] distribution - the distribution of the step
+    * \ingroup stochastic
+    */
+  template <typename Type, size_t N, template<class> class SearchSpace>
+  void takeStep(Type step, const std::array<Type, N>& current, const SearchSpace<Type>& searchSpace, std::array<Type, N>& out,
+                randomGenerators::Distribution distribution = randomGenerators::Distribution::UNIFORM)
+  {
+    if (distribution != randomGenerators::Distribution::UNIFORM)
+    {
+      takeStep(step, std::span<const Type>(current), searchSpace, std::span<Type>(out), distribution);
+      return;
+    }
+
+    const auto l = searchSpace.left();
+    const auto r = searchSpace.right();
+    auto& engine = randomGenerators::DefaultRandomEngine::bulk();
+    utility::unroll<N>([&](auto d)
+      {
+        const auto left = std::max(current[d] - step, l);
+        const auto right = std::min(current[d] + step, r);
+        if constexpr (std::is_integral_v<Type>)
+        {
+          out[d] = randomGenerators::generateUniformDistributedRandomNumber(left, right);
+        }
+        else
+        {
+          out[d] = left + static_cast<Type>(engine.unit()) * (right - left);
+        }
+      });
+  }
+
 
   /*!
     * \brief Computes the steps needed by the algorithm.    
     * \tparam Type - the data type used by the algorithm
-    * \tparam Parameters - the type of the position
+    * \tparam Position - the type of the position (any contiguous range of Type)
     * \tparam SearchSpace - the search space type
     * \tparam ObjectiveFunctionType - the type of the cost function
     *
@@ -68,18 +153,26 @@ namespace stochastic {
     * \param[out] bigStepParameters - the position as per big step
     * \param[out] stepCost - the cost of the step position
     * \param[out] bigStepCost - the cost of the big step position
+    * \param[in] stepDistribution - the distribution of the steps (see takeStep)
     *
     * \ingroup stochastic
     */
-  template <typename Type, template <class, class> class Parameters, template <class> class SearchSpace, class ObjectiveFunctionType>
-  void computeSteps(const STD_VECTOR(Type, Parameters)& current, ObjectiveFunctionType objectiveFunction, const SearchSpace<Type>& searchSpace, Type stepSize, Type bigStepSize,
-                    STD_VECTOR(Type, Parameters)& stepParameters, STD_VECTOR(Type, Parameters)& bigStepParameters,
-                    Type& stepCost, Type& bigStepCost)
+  template <typename Type, class Position, template <class> class SearchSpace, class ObjectiveFunctionType>
+    requires utility::ContiguousRangeOf<Position, Type>
+  void computeSteps(const Position& current, ObjectiveFunctionType objectiveFunction, const SearchSpace<Type>& searchSpace, Type stepSize, Type bigStepSize,
+                    Position& stepParameters, Position& bigStepParameters,
+                    Type& stepCost, Type& bigStepCost,
+                    randomGenerators::Distribution stepDistribution = randomGenerators::Distribution::UNIFORM)
   {
     // each iteration we'll trial two steps: one with a small step size and one with a big step size.
-    takeStep(stepSize, current, searchSpace, stepParameters);
-    takeStep(bigStepSize, current, searchSpace, bigStepParameters);
+    {
+      TRACE_ZONE("adaptiveRandomSearch/takeStep");
+      // std::array positions take the unrolled step, the others convert to spans
+      takeStep(stepSize, current, searchSpace, stepParameters, stepDistribution);
+      takeStep(bigStepSize, current, searchSpace, bigStepParameters, stepDistribution);
+    }
 
+    TRACE_ZONE("adaptiveRandomSearch/objective");
     stepCost = objectiveFunction(stepParameters);
     bigStepCost = objectiveFunction(bigStepParameters);
   }
@@ -123,13 +216,17 @@ namespace stochastic {
     *   - if no improvement is made for a longer period smaller step sizes will be considered.
     *
     * \tparam Type - the data type used by the algorithm
+    * \tparam Position - the position type: an owning contiguous container of Type (std::vector with any allocator,
+    *                    std::pmr::vector from a utility::RunArena, std::array)
     * \tparam SearchSpace - the search space
-    * \tparam ObjectiveFunctionType - the type of the cost function
+    * \tparam ObjectiveFunctionType - the type of the cost function; receives a Position
     * \tparam RandomGenerationFunction - the type of the random generation function
     * \tparam CostComparatorFunction - the cost comparator function 
+    * \tparam Observer - the convergence observer (see statistics::NullObserver)
+    * \tparam Stopping - the stopping criteria (see utility::StoppingCriteria); two evaluations per iteration
     *
     * \param[in] iterations - the number of iterations the algorithm will use to reach the solution
-    * \param[in] problemSize - the input size
+    * \param[in,out] position - storage for the position; its size is the input size. Holds the best position on return
     * \param[in] searchSpace - the search space
     * \param[in] objectiveFunction - pointer to the cost function
     * \param[in] randomFunction - pointer to the random generator
@@ -139,13 +236,20 @@ namespace stochastic {
     * \param[in] ssLargeFactor - the large big step factor
     * \param[in] ssIterationFactor - the number of iterations after which a large big step will be trialled
     * \param[in] noChangeMax - the number after which a smaller step will be trialled
+    * \param[in] stepDistribution - the distribution of the steps (see takeStep); Levy flights escape local optima more often
+    * \param[in] observer - notified of every accepted cost
+    * \param[in] stopping - ends the search early; position holds the best position so far
     *
     * \return the desired optima
     * \ingroup stochastic
     */
-  template <typename Type, template <class> class SearchSpace, class ObjectiveFunctionType, class RandomGenerationFunction, class CostComparatorFunction>
-  Type adaptiveRandomSearch(size_t iterations, size_t problemSize, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, RandomGenerationFunction randomFunction, CostComparatorFunction costComparator,
-                            Type ssInitFactor, Type ssSmallFactor, Type ssLargeFactor, size_t ssIterationFactor, size_t noChangeMax)
+  template <typename Type, class Position, template <class> class SearchSpace, class ObjectiveFunctionType, class RandomGenerationFunction, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+    requires utility::PositionOf<Position, Type>
+  Type adaptiveRandomSearch(size_t iterations, Position& position, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, RandomGenerationFunction randomFunction, CostComparatorFunction costComparator,
+                            Type ssInitFactor, Type ssSmallFactor, Type ssLargeFactor, size_t ssIterationFactor, size_t noChangeMax,
+                            randomGenerators::Distribution stepDistribution = randomGenerators::Distribution::UNIFORM,
+                            Observer&& observer = Observer(), Stopping&& stopping = Stopping())
   {
     // the counter of no changes
     auto noChangeCounter = 0;
@@ -153,38 +257,53 @@ namespace stochastic {
     // initial step here
     auto stepSize = searchSpace.length() * ssInitFactor;
 
-    auto position = randomGenerators::generateRandomVector<Type, std::vector>(problemSize, searchSpace.left(), searchSpace.right(), randomGenerators::Distribution::UNIFORM);
+    randomGenerators::generateRandomVector<Type>(utility::asSpan(position), searchSpace.left(), searchSpace.right(), randomGenerators::Distribution::UNIFORM);
     auto positionCost = objectiveFunction(position);
 
     auto csCost = positionCost;
+    observer.improved(0, static_cast<double>(csCost));
+    stopping.improved(static_cast<double>(csCost));
     auto ssCost = static_cast<Type>(0);
     auto bssCost = static_cast<Type>(0);
-    std::vector<Type> stepParameters; stepParameters.reserve(problemSize);
-    std::vector<Type> bigStepParameters; bigStepParameters.reserve(problemSize);
+
+    // the trial positions are copies of the position, so they share its container and allocator
+    // (a std::pmr position keeps its scratch in the same arena)
+    auto stepParameters = utility::copyWithAllocator(position);
+    auto bigStepParameters = utility::copyWithAllocator(position);
 
 
     // do the iterations
+    TRACE_ZONE("adaptiveRandomSearch");
     FOR(i, iterations)
     {
-      stepParameters.clear();
-      bigStepParameters.clear();
+      // deadline, budget, target, ... - position already holds the best so far
+      if (stopping.evaluated(i ? 2 : 1))
+      {
+        break;
+      }
 
       auto bigStepSize = computeLargeStepSize(i, stepSize, ssSmallFactor, ssLargeFactor, ssIterationFactor);
 
-      computeSteps(position, objectiveFunction,  searchSpace, stepSize, bigStepSize, stepParameters, bigStepParameters, ssCost, bssCost);            
+      computeSteps(position, objectiveFunction,  searchSpace, stepSize, bigStepSize, stepParameters, bigStepParameters, ssCost, bssCost, stepDistribution);            
 
+      TRACE_ZONE("adaptiveRandomSearch/bookkeeping");
+      // the trial buffers are fully overwritten by the next step, so swapping is enough
       if (costComparator(csCost, ssCost))
       {
         csCost = ssCost;
-        position = stepParameters;
+        std::swap(position, stepParameters);
         noChangeCounter = 0;
+        observer.improved(i, static_cast<double>(csCost));
+        stopping.improved(static_cast<double>(csCost));
       }
       else if (costComparator(csCost, bssCost))
       {
         stepSize = bigStepSize;
         csCost = bssCost;
-        position = bigStepParameters;
+        std::swap(position, bigStepParameters);
         noChangeCounter = 0;
+        observer.improved(i, static_cast<double>(csCost));
+        stopping.improved(static_cast<double>(csCost));
       }
       else
       {
@@ -200,6 +319,54 @@ namespace stochastic {
     return csCost;
   }
 
+
+  /*!
+    * \brief The adaptive random search algorithm, on a position of problemSize
+    *
+    * Up to utility::MAX_FIXED_DIMENSION the position is a std::array<Type, problemSize>, selected at compile time
+    * (see utility::dispatchDimension), when the objective function accepts one (a generic lambda or a
+    * std::span<const Type>): no allocations and unrolled steps. Otherwise it is a std::vector<Type>.
+    * See the overload above for the algorithm and the parameters.
+    * \param[in] problemSize - the input size
+    *
+    * \return the desired optima
+    * \ingroup stochastic
+    */
+  template <typename Type, template <class> class SearchSpace, class ObjectiveFunctionType, class RandomGenerationFunction, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+  Type adaptiveRandomSearch(size_t iterations, size_t problemSize, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, RandomGenerationFunction randomFunction, CostComparatorFunction costComparator,
+                            Type ssInitFactor, Type ssSmallFactor, Type ssLargeFactor, size_t ssIterationFactor, size_t noChangeMax,
+                            randomGenerators::Distribution stepDistribution = randomGenerators::Distribution::UNIFORM,
+                            Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    const auto search = [&](auto& position)
+    {
+      return adaptiveRandomSearch(iterations, position, searchSpace, objectiveFunction, randomFunction, costComparator, ssInitFactor, ssSmallFactor, ssLargeFactor, ssIterationFactor, noChangeMax,
+                                  stepDistribution, std::forward<Observer>(observer), std::forward<Stopping>(stopping));
+    };
+    const auto dynamic = [&]()
+    {
+      std::vector<Type> position(problemSize);
+      return search(position);
+    };
+
+    return utility::dispatchDimension(problemSize,
+      [&](auto dimension)
+      {
+        using Position = std::array<Type, decltype(dimension)::value>;
+        if constexpr (std::invocable<ObjectiveFunctionType&, Position&>)
+        {
+          Position position{};
+          return search(position);
+        }
+        else
+        {
+          return dynamic();
+        }
+      },
+      dynamic);
+  }
+
   namespace unitTest {
     double adaptiveRandomSearchMin();
   }
@@ -0,0 +1,34 @@
+#include <cassert>
+
+#include "../statistics/clock.h"
+#include "../utility/Defines.h"
+#include "CmaEvolutionStrategy.h"
+
+double stochastic::unitTest::cmaEvolutionStrategyMin()
+{
+  stochastic::CmaEvolutionStrategyOptions options;
+  options.population = 10;
+
+  const auto result = stochastic::cmaEvolutionStrategy(
+    BENCHMARK_ITERATIONS / options.population,                            // generations: the same evaluations as the other algorithms
+    BENCHMARK_PROBLEM_SIZE,
+    stochastic::SearchSpace2D<double>(-5, 5),
+    [](const std::vector<double>& xi) {                                   // function to evaluate 
+      auto sum = 0.0;
+      for (size_t i = 0; i < xi.size(); ++i)
+      {
+        sum += (xi[i] * xi[i]);
+      }
+
+      return sum;
+    },
+    [](double oldOptimal, double valueToCheck) {                          // cost comparator function
+      return valueToCheck < oldOptimal;
+    },
+    options
+  );
+
+  // on a sphere the step size adapts geometrically: far below this
+  assert(result < 1e-9);
+  return result;
+}
@@ -0,0 +1,365 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: implementation of the covariance matrix adaptation evolution strategy (CMA-ES)
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __CMA_EVOLUTION_STRATEGY_H__
+#define __CMA_EVOLUTION_STRATEGY_H__
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "../utility/Concepts.h"
+#include "../utility/LinearAlgebra.h"
+#include "../random_generators/vectorGenerator.h"
+#include "../statistics/trace.h"
+#include "../utility/StoppingCriteria.h"
+#include "../statistics/convergence.h"
+
+#include "RandomSearch.h"
+#include "Population.h"
+
+namespace stochastic {
+
+  /*! \class CmaEvolutionStrategyOptions "CmaEvolutionStrategy.h"
+    * \brief The parameters of cmaEvolutionStrategy; everything else follows Hansen's defaults for the problem size.
+    * \ingroup stochastic
+    */
+  struct CmaEvolutionStrategyOptions
+  {
+    size_t population = 0;/*!< lambda, the samples per generation; 0 picks 4 + 3 ln(dimensions) */
+    double initialSigma = 0.3;/*!< the initial step size, relative to the search space length */
+    size_t threads = 1;/*!< the threads evaluating the objective; the objective must be callable concurrently when > 1 */
+  };
+
+
+  /*! \class CmaState "CmaEvolutionStrategy.h"
+    * \brief The state of the strategy: the mean, the step size, the covariance matrix, its eigen decomposition and the evolution paths.
+    *
+    * Kept in double whatever the type of the positions: the covariance matrix needs the precision.
+    * \ingroup stochastic
+    */
+  struct CmaState
+  {
+    /*!
+      * \brief init c-tor; sets the learning rates of the problem size
+      * \param dimensions - the problem size
+      * \param lambda - the samples per generation
+      */
+    CmaState(size_t dimensions, size_t lambda) :
+      n(dimensions)
+    , lambda(lambda)
+    , mu(lambda / 2)
+    , weights(lambda / 2)
+    , mean(dimensions)
+    , pathSigma(dimensions, 0)
+    , pathC(dimensions, 0)
+    , eigenvalues(dimensions, 1)
+    , deviations(dimensions, 1)
+    , covariance(dimensions, 1)
+    , eigenvectors(dimensions, 1)
+    , scaledEigenvectors(dimensions, 1)
+    {
+      // log-linear recombination weights of the mu best samples
+      for (size_t i = 0; i < mu; ++i)
+      {
+        weights[i] = std::log((lambda + 1) / 2.0) - std::log(i + 1.0);
+      }
+      const auto sum = std::accumulate(weights.begin(), weights.end(), 0.0);
+      auto squares = 0.0;
+      for (auto& weight : weights)
+      {
+        weight /= sum;
+        squares += weight * weight;
+      }
+      muEffective = 1 / squares;
+
+      const auto size = static_cast<double>(n);
+      cc = (4 + muEffective / size) / (size + 4 + 2 * muEffective / size);
+      cs = (muEffective + 2) / (size + muEffective + 5);
+      c1 = 2 / ((size + 1.3) * (size + 1.3) + muEffective);
+      cmu = std::min(1 - c1, 2 * (muEffective - 2 + 1 / muEffective) / ((size + 2) * (size + 2) + muEffective));
+      damping = 1 + 2 * std::max(0.0, std::sqrt((muEffective - 1) / (size + 1)) - 1) + cs;
+      chiN = std::sqrt(size) * (1 - 1 / (4 * size) + 1 / (21 * size * size));
+      // the decomposition is O(n^3): refreshed once the covariance matrix moved enough (Hansen's lazy update)
+      eigenInterval = std::max<size_t>(static_cast<size_t>(1 / (c1 + cmu) / size / 10), 1);
+    }
+
+    //! recomputes B and D (and B D, the sampling matrix) from the covariance matrix
+    void decompose()
+    {
+      TRACE_ZONE("cmaEvolutionStrategy/eigen");
+      auto matrix = covariance;
+      symmetricEigen(matrix, std::span<double>(eigenvalues), eigenvectors);
+
+      const auto largest = *std::max_element(eigenvalues.begin(), eigenvalues.end());
+      for (size_t j = 0; j < n; ++j)
+      {
+        // a round-off negative (or tiny) eigenvalue would stop the sampling along its axis
+        eigenvalues[j] = std::max(eigenvalues[j], largest * 1e-14);
+        deviations[j] = std::sqrt(eigenvalues[j]);
+
+        const double* __restrict vector = eigenvectors.row(j);
+        double* __restrict scaled = scaledEigenvectors.row(j);
+        for (size_t k = 0; k < covariance.stride(); ++k)
+        {
+          scaled[k] = deviations[j] * vector[k];
+        }
+      }
+    }
+
+    size_t n;/*!< the problem size */
+    size_t lambda;/*!< the samples per generation */
+    size_t mu;/*!< the samples recombined into the new mean */
+    std::vector<double> weights;/*!< the recombination weights, best sample first */
+    double muEffective;/*!< the variance effective selection mass */
+    double cc, cs, c1, cmu, damping, chiN;/*!< the learning rates, the step size damping and E||N(0, I)|| */
+    size_t eigenInterval;/*!< the generations between two decompositions */
+
+    double sigma = 1;/*!< the step size */
+    std::vector<double> mean;/*!< the mean of the distribution */
+    std::vector<double> pathSigma;/*!< the conjugate evolution path, drives sigma */
+    std::vector<double> pathC;/*!< the evolution path, drives the rank one update */
+    std::vector<double> eigenvalues;/*!< D^2 */
+    std::vector<double> deviations;/*!< D */
+    utility::SquareMatrix<double> covariance;/*!< C */
+    utility::SquareMatrix<double> eigenvectors;/*!< B^T: the eigenvectors of C, one per row */
+    utility::SquareMatrix<double> scaledEigenvectors;/*!< (B D)^T: row j is D_j b_j, so a sample is a sum of rows */
+  };
+
+
+  /*!
+    * \brief The covariance matrix adaptation evolution strategy
+    * Algorithm: <br>
+    * - every generation samples lambda positions from N(m, sigma^2 C) and evaluates them (in parallel if asked);
+    * - the new mean is a weighted mean of the best mu samples;
+    * - C learns the directions of the successful steps: a rank one update from the evolution path and a rank mu
+    *   update from the selected steps; sigma grows or shrinks with the length of the conjugate evolution path.
+    *
+    * Invariant to rotations and scaling of the problem, it solves ill-conditioned and non separable problems
+    * that take random search (and DE) orders of magnitude more evaluations.
+    *
+    * The samples are rows of a PopulationMatrix; every sample and every covariance update is a sum of scaled
+    * contiguous rows, so the O(n^2) work vectorizes. The eigen decomposition (Householder + QL, O(n^3)) only runs
+    * once the covariance matrix moved enough. Samples are clamped to the search space and the strategy
+    * learns from the clamped steps. The random numbers are drawn by the calling thread, so the result only
+    * depends on the seed, not on the number of threads.
+    * \tparam Type - the data type used by the algorithm
+    * \tparam Position - the position type: any contiguous container of Type
+    * \tparam SearchSpace - the search space
+    * \tparam ObjectiveFunctionType - the type of the cost function; receives a std::span<const Type> or a std::vector<Type>
+    * \tparam CostComparatorFunction - the cost comparator function, true when the second cost is better
+    * \tparam Observer - the convergence observer (see statistics::NullObserver)
+    * \tparam Stopping - the stopping criteria (see utility::StoppingCriteria); one evaluation per sample
+    *
+    * \param[in] generations - the number of generations; every generation evaluates lambda samples
+    * \param[in,out] position - storage for the position; its size is the input size. Holds the best position on return
+    * \param[in] searchSpace - the search space
+    * \param[in] objectiveFunction - the cost function
+    * \param[in] costComparator - the cost comparator
+    * \param[in] options - the algorithm parameters
+    * \param[in] observer - notified of every improvement of the best cost
+    * \param[in] stopping - ends the search early; position holds the best position so far
+    *
+    * \return the best cost found
+    * \ingroup stochastic
+    */
+  template <typename Type, class Position, template <class> class SearchSpace, class ObjectiveFunctionType, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+    requires utility::ContiguousRangeOf<Position, Type>
+  Type cmaEvolutionStrategy(size_t generations, Position& position, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, CostComparatorFunction costComparator,
+                            const CmaEvolutionStrategyOptions& options = CmaEvolutionStrategyOptions(), Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    const auto n = std::ranges::size(position);
+    const auto lambda = options.population ? std::max<size_t>(options.population, 2) : 4 + static_cast<size_t>(3 * std::log(static_cast<double>(n)));
+    const auto left = searchSpace.left();
+    const auto right = searchSpace.right();
+    auto& engine = randomGenerators::DefaultRandomEngine::bulk();
+
+    CmaState state(n, lambda);
+    state.sigma = options.initialSigma * searchSpace.length();
+    engine.fillUniform<double>(state.mean, left, right);
+
+    PopulationMatrix<double> normals(lambda, n), steps(lambda, n);
+    PopulationMatrix<Type> samples(lambda, n);
+    const auto stride = steps.stride();
+    std::vector<Type> costs(lambda);
+    std::vector<size_t> ranking(lambda);
+    std::vector<double> meanStep(n), whitened(n);
+
+    auto bestCost = static_cast<Type>(0);
+    auto found = false;
+    size_t lastDecomposition = 0;
+
+    for (size_t generation = 0; generation < generations; ++generation)
+    {
+      {
+        TRACE_ZONE("cmaEvolutionStrategy/sample");
+        randomGenerators::fillGaussian(engine, std::span<double>(normals.data()), 0.0, 1.0);
+
+        for (size_t k = 0; k < lambda; ++k)
+        {
+          // y = B D z: the sum of the rows of (B D)^T weighted by z
+          double* __restrict y = steps.data().data() + k * stride;
+          const double* z = normals.row(k).data();
+          std::fill_n(y, stride, 0.0);
+          for (size_t j = 0; j < n; ++j)
+          {
+            const auto factor = z[j];
+            const double* __restrict row = state.scaledEigenvectors.row(j);
+            for (size_t d = 0; d < stride; ++d)
+            {
+              y[d] += factor * row[d];
+            }
+          }
+
+          // x = m + sigma y, clamped; the step is recomputed from the clamped sample
+          auto x = samples.row(k);
+          for (size_t d = 0; d < n; ++d)
+          {
+            x[d] = static_cast<Type>(std::clamp(state.mean[d] + state.sigma * y[d], static_cast<double>(left), static_cast<double>(right)));
+            y[d] = (x[d] - state.mean[d]) / state.sigma;
+          }
+        }
+      }
+
+      evaluatePopulation<Type>(lambda, [&](size_t k) { return samples.row(k); }, objectiveFunction, std::span<Type>(costs), options.threads);
+
+      TRACE_ZONE("cmaEvolutionStrategy/update");
+      std::iota(ranking.begin(), ranking.end(), size_t(0));
+      std::partial_sort(ranking.begin(), ranking.begin() + state.mu, ranking.end(), [&](size_t a, size_t b) { return costComparator(costs[b], costs[a]); });
+
+      if (!found || costComparator(bestCost, costs[ranking[0]]))
+      {
+        found = true;
+        bestCost = costs[ranking[0]];
+        std::copy_n(samples.row(ranking[0]).data(), n, std::ranges::data(position));
+        observer.improved(generation, static_cast<double>(bestCost));
+        stopping.improved(static_cast<double>(bestCost));
+      }
+
+      // the mean moves by sigma times the weighted mean step
+      std::fill(meanStep.begin(), meanStep.end(), 0.0);
+      for (size_t i = 0; i < state.mu; ++i)
+      {
+        const auto weight = state.weights[i];
+        const double* __restrict y = steps.row(ranking[i]).data();
+        double* __restrict target = meanStep.data();
+        for (size_t d = 0; d < n; ++d)
+        {
+          target[d] += weight * y[d];
+        }
+      }
+      for (size_t d = 0; d < n; ++d)
+      {
+        state.mean[d] += state.sigma * meanStep[d];
+      }
+
+      // C^-1/2 y_w = B D^-1 B^T y_w, for the conjugate path
+      std::fill(whitened.begin(), whitened.end(), 0.0);
+      for (size_t j = 0; j < n; ++j)
+      {
+        const auto* vector = state.eigenvectors.row(j);
+        auto projection = 0.0;
+        for (size_t d = 0; d < n; ++d)
+        {
+          projection += vector[d] * meanStep[d];
+        }
+        projection /= state.deviations[j];
+        for (size_t d = 0; d < n; ++d)
+        {
+          whitened[d] += projection * vector[d];
+        }
+      }
+
+      const auto sigmaFactor = std::sqrt(state.cs * (2 - state.cs) * state.muEffective);
+      auto pathNorm = 0.0;
+      for (size_t d = 0; d < n; ++d)
+      {
+        state.pathSigma[d] = (1 - state.cs) * state.pathSigma[d] + sigmaFactor * whitened[d];
+        pathNorm += state.pathSigma[d] * state.pathSigma[d];
+      }
+      pathNorm = std::sqrt(pathNorm);
+
+      // the rank one update stalls while sigma is growing fast (Heaviside hsig)
+      const auto hsig = pathNorm / std::sqrt(1 - std::pow(1 - state.cs, 2.0 * (generation + 1))) / state.chiN < 1.4 + 2 / (n + 1.0);
+      const auto cFactor = hsig ? std::sqrt(state.cc * (2 - state.cc) * state.muEffective) : 0.0;
+      for (size_t d = 0; d < n; ++d)
+      {
+        state.pathC[d] = (1 - state.cc) * state.pathC[d] + cFactor * meanStep[d];
+      }
+
+      // C = decay C + c1 pc pc^T + cmu sum w_i y_i y_i^T, row by row
+      const auto decay = 1 - state.c1 - state.cmu + (hsig ? 0 : state.c1 * state.cc * (2 - state.cc));
+      for (size_t r = 0; r < n; ++r)
+      {
+        double* __restrict row = state.covariance.row(r);
+        const double* __restrict pc = state.pathC.data();
+        const auto rankOne = state.c1 * pc[r];
+        for (size_t d = 0; d < n; ++d)
+        {
+          row[d] = decay * row[d] + rankOne * pc[d];
+        }
+
+        for (size_t i = 0; i < state.mu; ++i)
+        {
+          const double* __restrict y = steps.row(ranking[i]).data();
+          const auto factor = state.cmu * state.weights[i] * y[r];
+          for (size_t d = 0; d < n; ++d)
+          {
+            row[d] += factor * y[d];
+          }
+        }
+      }
+
+      state.sigma *= std::exp(state.cs / state.damping * (pathNorm / state.chiN - 1));
+      if (!std::isfinite(state.sigma) || state.sigma <= 0)
+      {
+        break;
+      }
+
+      if (generation + 1 - lastDecomposition >= state.eigenInterval)
+      {
+        lastDecomposition = generation + 1;
+        state.decompose();
+      }
+
+      if (stopping.evaluated(lambda))
+      {
+        break;
+      }
+    }
+
+    return bestCost;
+  }
+
+
+  /*!
+    * \brief The covariance matrix adaptation evolution strategy, on a std::vector<Type> position of problemSize
+    *
+    * See the overload above for the algorithm and the parameters.
+    * \param[in] problemSize - the input size
+    *
+    * \return the best cost found
+    * \ingroup stochastic
+    */
+  template <typename Type, template <class> class SearchSpace, class ObjectiveFunctionType, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+  Type cmaEvolutionStrategy(size_t generations, size_t problemSize, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, CostComparatorFunction costComparator,
+                            const CmaEvolutionStrategyOptions& options = CmaEvolutionStrategyOptions(), Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    std::vector<Type> position(problemSize);
+    return cmaEvolutionStrategy(generations, position, searchSpace, objectiveFunction, costComparator, options, std::forward<Observer>(observer), std::forward<Stopping>(stopping));
+  }
+
+  namespace unitTest {
+    double cmaEvolutionStrategyMin();
+  }
+}
+
+#endif // !__CMA_EVOLUTION_STRATEGY_H__
@@ -0,0 +1,34 @@
+#include <cassert>
+
+#include "../statistics/clock.h"
+#include "../utility/Defines.h"
+#include "DifferentialEvolution.h"
+
+double stochastic::unitTest::differentialEvolutionMin()
+{
+  stochastic::DifferentialEvolutionOptions options;
+  options.population = 20;
+
+  const auto result = stochastic::differentialEvolution(
+    BENCHMARK_ITERATIONS / options.population,                            // generations: the same evaluations as the other algorithms
+    BENCHMARK_PROBLEM_SIZE,
+    stochastic::SearchSpace2D<double>(-5, 5),
+    [](const std::vector<double>& xi) {                                   // function to evaluate 
+      auto sum = 0.0;
+      for (size_t i = 0; i < xi.size(); ++i)
+      {
+        sum += (xi[i] * xi[i]);
+      }
+
+      return sum;
+    },
+    [](double oldOptimal, double valueToCheck) {                          // cost comparator function
+      return valueToCheck < oldOptimal;
+    },
+    options
+  );
+
+  // the population closes in on the minimum (0) to about 1e-8
+  assert(result < 1e-4);
+  return result;
+}
@@ -0,0 +1,298 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: implementation of the differential evolution algorithm (DE/rand/1/bin and JADE)
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __DIFFERENTIAL_EVOLUTION_H__
+#define __DIFFERENTIAL_EVOLUTION_H__
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "../utility/Concepts.h"
+#include "../random_generators/vectorGenerator.h"
+#include "../statistics/trace.h"
+#include "../utility/StoppingCriteria.h"
+#include "../statistics/convergence.h"
+
+#include "RandomSearch.h"
+#include "Population.h"
+
+namespace stochastic {
+
+  /*!
+    \brief the mutation / adaptation scheme of differentialEvolution
+    \ingroup stochastic
+  */
+  enum class DifferentialEvolutionStrategy
+  {
+    RAND_1_BIN,/*!< the classic DE/rand/1/bin: v = x_r1 + F (x_r2 - x_r3), fixed F and CR */
+    JADE/*!< DE/current-to-pbest/1 with an archive; F and CR drawn per individual around means adapted to what succeeded (Zhang & Sanderson) */
+  };
+
+  /*! \class DifferentialEvolutionOptions "DifferentialEvolution.h"
+    * \brief The parameters of differentialEvolution.
+    * \ingroup stochastic
+    */
+  struct DifferentialEvolutionOptions
+  {
+    size_t population = 0;/*!< the population size; 0 picks 10 x dimensions, within [20, 100] */
+    DifferentialEvolutionStrategy strategy = DifferentialEvolutionStrategy::JADE;/*!< the mutation scheme */
+    double differentialWeight = 0.5;/*!< F for RAND_1_BIN; the initial mean of F for JADE */
+    double crossoverRate = 0.9;/*!< CR for RAND_1_BIN; JADE starts from a mean of 0.5 */
+    double adaptationRate = 0.1;/*!< c: how fast the JADE means follow the successful F and CR */
+    double greediness = 0.05;/*!< p: JADE's pbest is drawn from the best p x population individuals */
+    size_t threads = 1;/*!< the threads evaluating the objective; the objective must be callable concurrently when > 1 */
+  };
+
+
+  /*!
+    * \brief Builds one trial vector: mutant = base + F (a - b) + G (c - e), then binomial crossover with the parent
+    *
+    * Branch free over the whole row, so it vectorizes; a mutant coordinate outside the search space is put halfway
+    * between the parent and the violated bound.
+    * \param[out] trial - the trial row
+    * \param[in] parent - the parent row
+    * \param[in] base, a, b, c, e - the rows of the mutation
+    * \param[in] random - uniform numbers in [0, 1), one per coordinate; a coordinate crosses over when it is below crossoverRate
+    * \param[in] stride - the row length
+    * \ingroup stochastic
+    */
+  template <typename Type>
+  void makeTrial(Type* __restrict trial, const Type* __restrict parent, const Type* base, const Type* a, const Type* b, const Type* c, const Type* e,
+                 Type f, Type g, const Type* __restrict random, Type crossoverRate, size_t stride, Type left, Type right)
+  {
+    for (size_t d = 0; d < stride; ++d)
+    {
+      auto mutant = base[d] + f * (a[d] - b[d]) + g * (c[d] - e[d]);
+      mutant = mutant < left ? (left + parent[d]) / 2 : mutant;
+      mutant = mutant > right ? (right + parent[d]) / 2 : mutant;
+      trial[d] = random[d] < crossoverRate ? mutant : parent[d];
+    }
+  }
+
+
+  /*!
+    * \brief A random index in [0, count), from the upper bits of one word (Lemire's multiply-shift, the bias is below count / 2^32)
+    * \ingroup stochastic
+    */
+  inline size_t randomIndex(randomGenerators::BulkRandomEngine& engine, size_t count)
+  {
+    return static_cast<size_t>(((engine() >> 32) * count) >> 32);
+  }
+
+
+  /*!
+    * \brief The differential evolution algorithm
+    * Algorithm: <br>
+    * - every individual of the population gets a trial vector: a mutant built from scaled differences of other
+    *   individuals, crossed over coordinate by coordinate with the individual itself;
+    * - all the trial vectors of a generation are evaluated (in parallel if asked);
+    * - a trial vector replaces its parent when it is not worse.
+    *
+    * JADE mutates towards one of the best individuals (x_i + F (x_pbest - x_i) + F (x_r1 - x_r2), x_r2 possibly a
+    * replaced parent from the archive) and adapts F and CR to the values that produced improvements; it needs
+    * far fewer evaluations on large problems.
+    *
+    * The population and the trial vectors are PopulationMatrix rows; the random numbers of a generation are drawn
+    * by the calling thread, so the result only depends on the seed, not on the number of threads.
+    * \tparam Type - the data type used by the algorithm
+    * \tparam Position - the position type: any contiguous container of Type
+    * \tparam SearchSpace - the search space
+    * \tparam ObjectiveFunctionType - the type of the cost function; receives a std::span<const Type> or a std::vector<Type>
+    * \tparam CostComparatorFunction - the cost comparator function, true when the second cost is better
+    * \tparam Observer - the convergence observer (see statistics::NullObserver)
+    * \tparam Stopping - the stopping criteria (see utility::StoppingCriteria); one evaluation per trial vector
+    *
+    * \param[in] generations - the number of generations; every generation evaluates population trial vectors
+    * \param[in,out] position - storage for the position; its size is the input size. Holds the best position on return
+    * \param[in] searchSpace - the search space
+    * \param[in] objectiveFunction - the cost function
+    * \param[in] costComparator - the cost comparator
+    * \param[in] options - the algorithm parameters
+    * \param[in] observer - notified of every improvement of the best cost
+    * \param[in] stopping - ends the search early; position holds the best position so far
+    *
+    * \return the best cost found
+    * \ingroup stochastic
+    */
+  template <typename Type, class Position, template <class> class SearchSpace, class ObjectiveFunctionType, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+    requires utility::ContiguousRangeOf<Position, Type>
+  Type differentialEvolution(size_t generations, Position& position, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, CostComparatorFunction costComparator,
+                             const DifferentialEvolutionOptions& options = DifferentialEvolutionOptions(), Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    const auto dimensions = std::ranges::size(position);
+    const auto size = options.population ? std::max<size_t>(options.population, 4) : std::clamp<size_t>(10 * dimensions, 20, 100);
+    const auto jade = options.strategy == DifferentialEvolutionStrategy::JADE;
+    const auto left = searchSpace.left();
+    const auto right = searchSpace.right();
+    auto& engine = randomGenerators::DefaultRandomEngine::bulk();
+
+    PopulationMatrix<Type> population(size, dimensions), trials(size, dimensions);
+    const auto stride = population.stride();
+    engine.fillUniform<Type>(population.data(), left, right);
+
+    std::vector<Type> costs(size), trialCosts(size);
+    evaluatePopulation<Type>(size, [&](size_t i) { return population.row(i); }, objectiveFunction, std::span<Type>(costs), options.threads);
+
+    size_t best = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+      if (costComparator(costs[best], costs[i]))
+      {
+        best = i;
+      }
+    }
+    observer.improved(0, static_cast<double>(costs[best]));
+    stopping.improved(static_cast<double>(costs[best]));
+
+    // JADE: the archive of replaced parents, the adapted means and the per individual parameters
+    PopulationMatrix<Type> archive(jade ? size : 0, dimensions);
+    size_t archived = 0;
+    auto meanF = options.differentialWeight;
+    auto meanCrossover = 0.5;
+    std::vector<double> weights(size, options.differentialWeight), crossoverRates(size, options.crossoverRate);
+    std::vector<size_t> ranking(size);
+    std::iota(ranking.begin(), ranking.end(), size_t(0));
+    const auto greedy = std::max<size_t>(static_cast<size_t>(std::lround(options.greediness * size)), 1);
+
+    utility::AlignedVector<Type> random(size * stride);
+    for (size_t generation = 0; generation < generations; ++generation)
+    {
+      // counts the previous evaluation of the population
+      if (stopping.evaluated(size))
+      {
+        break;
+      }
+
+      {
+        TRACE_ZONE("differentialEvolution/trials");
+        engine.fillUniform<Type>(random, static_cast<Type>(0), static_cast<Type>(1));
+
+        if (jade)
+        {
+          std::partial_sort(ranking.begin(), ranking.begin() + greedy, ranking.end(), [&](size_t a, size_t b) { return costComparator(costs[b], costs[a]); });
+        }
+
+        for (size_t i = 0; i < size; ++i)
+        {
+          // the distinct partners, none of them the individual itself
+          size_t r1, r2, r3;
+          do { r1 = randomIndex(engine, size); } while (r1 == i);
+          do { r2 = randomIndex(engine, size + archived); } while (r2 == i || r2 == r1);
+          do { r3 = randomIndex(engine, size); } while (r3 == i || r3 == r1 || r3 == r2);
+
+          if (jade)
+          {
+            // F ~ Cauchy(meanF, 0.1) redrawn until positive, at most 1; CR ~ N(meanCR, 0.1) within [0, 1]
+            do { weights[i] = meanF + 0.1 * std::tan(std::numbers::pi * (engine.unit() - 0.5)); } while (weights[i] <= 0);
+            weights[i] = std::min(weights[i], 1.0);
+            crossoverRates[i] = std::clamp(meanCrossover + 0.1 * randomGenerators::standardGaussian(engine, engine()), 0.0, 1.0);
+          }
+
+          // one coordinate always comes from the mutant
+          auto* uniform = random.data() + i * stride;
+          uniform[randomIndex(engine, dimensions)] = static_cast<Type>(-1);
+
+          const auto* parent = population.row(i).data();
+          const auto f = static_cast<Type>(weights[i]);
+          if (jade)
+          {
+            const auto* pbest = population.row(ranking[randomIndex(engine, greedy)]).data();
+            const auto* partner = r2 < size ? population.row(r2).data() : archive.row(r2 - size).data();
+            makeTrial(trials.row(i).data(), parent, parent, pbest, parent, population.row(r1).data(), partner,
+                      f, f, uniform, static_cast<Type>(crossoverRates[i]), stride, left, right);
+          }
+          else
+          {
+            const auto* base = population.row(r1).data();
+            makeTrial(trials.row(i).data(), parent, base, population.row(r2).data(), population.row(r3).data(), base, base,
+                      f, static_cast<Type>(0), uniform, static_cast<Type>(crossoverRates[i]), stride, left, right);
+          }
+        }
+      }
+
+      evaluatePopulation<Type>(size, [&](size_t i) { return trials.row(i); }, objectiveFunction, std::span<Type>(trialCosts), options.threads);
+
+      TRACE_ZONE("differentialEvolution/selection");
+      auto improved = false;
+      auto sumCrossover = 0.0, sumF = 0.0, sumSquaredF = 0.0;
+      size_t successes = 0;
+      for (size_t i = 0; i < size; ++i)
+      {
+        if (costComparator(trialCosts[i], costs[i]))
+        {
+          continue;
+        }
+
+        if (jade && costComparator(costs[i], trialCosts[i]))
+        {
+          // the replaced parent goes to the archive; a full archive loses a random member
+          const auto slot = archived < size ? archived++ : randomIndex(engine, size);
+          std::copy_n(population.row(i).data(), stride, archive.row(slot).data());
+
+          ++successes;
+          sumCrossover += crossoverRates[i];
+          sumF += weights[i];
+          sumSquaredF += weights[i] * weights[i];
+        }
+
+        costs[i] = trialCosts[i];
+        std::copy_n(trials.row(i).data(), stride, population.row(i).data());
+        if (costComparator(costs[best], costs[i]))
+        {
+          best = i;
+          improved = true;
+        }
+      }
+
+      if (successes)
+      {
+        // the arithmetic mean of the successful CR, the Lehmer mean of the successful F (favours larger steps)
+        meanCrossover = (1 - options.adaptationRate) * meanCrossover + options.adaptationRate * sumCrossover / successes;
+        meanF = (1 - options.adaptationRate) * meanF + options.adaptationRate * sumSquaredF / sumF;
+      }
+
+      if (improved)
+      {
+        observer.improved(generation, static_cast<double>(costs[best]));
+        stopping.improved(static_cast<double>(costs[best]));
+      }
+    }
+
+    std::copy_n(population.row(best).data(), dimensions, std::ranges::data(position));
+    return costs[best];
+  }
+
+
+  /*!
+    * \brief The differential evolution algorithm, on a std::vector<Type> position of problemSize
+    *
+    * See the overload above for the algorithm and the parameters.
+    * \param[in] problemSize - the input size
+    *
+    * \return the best cost found
+    * \ingroup stochastic
+    */
+  template <typename Type, template <class> class SearchSpace, class ObjectiveFunctionType, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+  Type differentialEvolution(size_t generations, size_t problemSize, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, CostComparatorFunction costComparator,
+                             const DifferentialEvolutionOptions& options = DifferentialEvolutionOptions(), Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    std::vector<Type> position(problemSize);
+    return differentialEvolution(generations, position, searchSpace, objectiveFunction, costComparator, options, std::forward<Observer>(observer), std::forward<Stopping>(stopping));
+  }
+
+  namespace unitTest {
+    double differentialEvolutionMin();
+  }
+}
+
+#endif // !__DIFFERENTIAL_EVOLUTION_H__
@@ -0,0 +1,56 @@
+#include <cassert>
+
+#include "../random_generators/vectorGenerator.h"
+
+#include "IslandHillClimbing.h"
+
+double stochastic::unitTest::islandClimbHill()
+{
+  static const size_t oneMaxSize = 1000;
+
+  // OneMax: flip random bits on, accept anything not worse; the same setup as climbHill, on every island
+  auto bitstring = randomGenerators::generateRandomVector<int, short>(oneMaxSize, 0, 1, randomGenerators::Distribution::UNIFORM);
+  auto costCalculator = [](const std::vector<short>& bitstring) -> size_t
+  {
+    return std::count_if(bitstring.begin(), bitstring.end(), [](int i) { return i != 0; });
+  };
+
+  auto costEvaluator = [&costCalculator](const std::vector<short>& candidate, const std::vector<short>& currentSolution)
+  {
+    return costCalculator(candidate) >= costCalculator(currentSolution);
+  };
+
+  auto neighbourGenerator = [](std::vector<short>& bitstring)
+  {
+    auto pos = randomGenerators::generateUniformDistributedRandomNumber<int>(0, static_cast<int>(bitstring.size() - 1));
+    bitstring[pos] = 1;
+  };
+
+  auto restart = [](std::vector<short>& bitstring)
+  {
+    for (auto& bit : bitstring)
+    {
+      bit = static_cast<short>(randomGenerators::generateUniformDistributedRandomNumber<int>(0, 1));
+    }
+  };
+
+  stochastic::IslandOptions options;
+  options.migrationInterval = 500;
+  options.seed = 0x15a4d;
+
+  const auto climb = [&](size_t threads)
+  {
+    options.threads = threads;
+    return stochastic::islandHillClimbing(10000, bitstring, neighbourGenerator, costEvaluator, costCalculator,
+      [](size_t oldCost, size_t newCost) { return newCost > oldCost; }, restart, options);
+  };
+
+  const auto solution = climb(0);
+  assert(costCalculator(solution) == oneMaxSize);
+
+  // the same seed gives the same solution, however many threads run the islands
+  assert(climb(0) == solution);
+  assert(climb(1) == solution);
+
+  return static_cast<double>(costCalculator(solution));
+}
@@ -0,0 +1,233 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: island model hill climbing - independent trajectories on the thread pool, with migration and restarts
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __ISLAND_HILL_CLIMBING_H__
+#define __ISLAND_HILL_CLIMBING_H__
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "../utility/Concepts.h"
+#include "../utility/StoppingCriteria.h"
+#include "../utility/ThreadPool.h"
+#include "../random_generators/vectorGenerator.h"
+#include "../statistics/convergence.h"
+
+#include "hillClimbing.h"
+
+namespace stochastic {
+
+  /*! \class IslandOptions "IslandHillClimbing.h"
+    * \brief The parameters of the island model.
+    * \ingroup stochastic
+    */
+  struct IslandOptions
+  {
+    size_t islands = 8;/*!< the number of trajectories; fixed, so the result does not depend on the threads running them */
+    size_t migrationInterval = 1000;/*!< the iterations of every island between two migrations (an epoch) */
+    size_t stagnationEpochs = 5;/*!< an island not improving for this many epochs restarts; 0: never */
+    size_t threads = 0;/*!< the maximum number of threads; 0: the whole shared pool */
+    std::optional<uint64_t> seed;/*!< the seed of the island streams; drawn from the calling thread's bulk engine when empty */
+  };
+
+
+  /*!
+    * \brief Island model hill climbing: many hillClimbing trajectories in parallel, sharing their discoveries.
+    *
+    * The run is split in epochs of migrationInterval iterations. In an epoch every island climbs on its own
+    * (the islands are spread over whatever threads the shared utility::ThreadPool has); between two epochs the islands that
+    * improved send a copy of their solution to the next island of a ring, which adopts it when it is better.
+    * An island that has not improved for stagnationEpochs epochs restarts from restart(), so the islands
+    * keep exploring after they converge; the best solution ever found is kept aside.
+    *
+    * The exchange needs no locks: an island only writes its own emigrant slot, and the slots are double
+    * buffered by epoch, so the slots read during an epoch (written by the previous one) are never written.
+    *
+    * Before every epoch of an island the running thread's random engines (see DefaultRandomEngine) are reseeded
+    * from (seed, island, epoch): the functions drawing from them give the same result on any number of
+    * threads, whichever worker runs the island. The engines are put back afterwards (see
+    * DefaultRandomEngine::ThreadStateGuard), so the only trace on the caller's streams is the draw of the
+    * seed when options.seed is empty.
+    *
+    * \tparam Solution - the solution type
+    * \tparam GenerateRandomNeighbourFunction - void(Solution&), see hillClimbing
+    * \tparam CostEvaluatorFunction - bool(const Solution& candidate, const Solution& current), see hillClimbing
+    * \tparam CostFunction - the cost of a solution, used for the migration, the restarts and the result
+    * \tparam CostComparatorFunction - bool(cost old, cost new), true when the new cost is better
+    * \tparam RestartFunction - void(Solution&), a new random solution (in place; the solution keeps its size)
+    * \tparam Observer - the convergence observer (see statistics::NullObserver); notified between epochs
+    * \tparam Stopping - the stopping criteria (see utility::StoppingCriteria); one evaluation per island
+    *                    iteration, checked between epochs
+    *
+    * \param[in] capIterations - the number of iterations of every island
+    * \param[in] initialSolution - the solution of island 0; the other islands start from restart()
+    * \param[in] randomNeighbour - the function that selects the neighbour to evaluate; called concurrently
+    * \param[in] costEvaluator - the function that evaluates the two solutions considered; called concurrently
+    * \param[in] cost - the cost of a solution; called concurrently
+    * \param[in] costComparator - compares two costs
+    * \param[in] restart - randomizes a solution; called concurrently
+    * \param[in] options - the island model parameters
+    * \param[in] observer - notified of every improvement of the best cost
+    * \param[in] stopping - ends the search early (between two epochs)
+    *
+    * \return the best solution found
+    * \ingroup stochastic
+    */
+  template <class Solution, class GenerateRandomNeighbourFunction, class CostEvaluatorFunction, class CostFunction, class CostComparatorFunction,
+            class RestartFunction, class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+  Solution islandHillClimbing(size_t capIterations, const Solution& initialSolution, GenerateRandomNeighbourFunction randomNeighbour, CostEvaluatorFunction costEvaluator,
+                              CostFunction cost, CostComparatorFunction costComparator, RestartFunction restart, const IslandOptions& options = IslandOptions(),
+                              Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    using Cost = std::remove_cvref_t<std::invoke_result_t<CostFunction&, const Solution&>>;
+
+    struct Island
+    {
+      Solution solution;
+      Cost cost;
+      size_t stagnant = 0;/*!< epochs without an improvement */
+    };
+
+    struct Emigrant
+    {
+      Solution solution;
+      Cost cost;
+      bool fresh = false;/*!< the island improved in the epoch that wrote it */
+    };
+
+    auto& pool = utility::ThreadPool::shared();
+    const auto islands = std::max<size_t>(options.islands, 1);
+    const auto interval = std::max<size_t>(options.migrationInterval, 1);
+    const auto epochs = (capIterations + interval - 1) / interval;
+    const auto seed = options.seed ? *options.seed : randomGenerators::DefaultRandomEngine::bulk()();
+    const auto reseed = [seed](size_t island, size_t epoch)
+    {
+      randomGenerators::DefaultRandomEngine::reseedThread(randomGenerators::mixSeed(randomGenerators::mixSeed(seed, island), epoch));
+    };
+
+    // epoch 0 of the streams initializes the islands
+    std::vector<Island> population;
+    population.reserve(islands);
+    {
+      const randomGenerators::DefaultRandomEngine::ThreadStateGuard guard;
+      FOR(i, islands)
+      {
+        auto solution = utility::copyWithAllocator(initialSolution);
+        if (i)
+        {
+          reseed(i, 0);
+          restart(solution);
+        }
+        const auto solutionCost = cost(solution);
+        population.push_back({ std::move(solution), solutionCost, 0 });
+      }
+    }
+
+    std::array<std::vector<Emigrant>, 2> emigrants;
+    for (auto& slots : emigrants)
+    {
+      FOR(i, islands)
+      {
+        slots.push_back({ utility::copyWithAllocator(initialSolution), population[i].cost, false });
+      }
+    }
+
+    auto best = utility::copyWithAllocator(initialSolution);
+    auto bestCost = population[0].cost;
+    FOR(i, islands)
+    {
+      if (i == 0 || costComparator(bestCost, population[i].cost))
+      {
+        best = population[i].solution;
+        bestCost = population[i].cost;
+      }
+    }
+    observer.improved(0, static_cast<double>(bestCost));
+    stopping.improved(static_cast<double>(bestCost));
+
+    FOR(epoch, epochs)
+    {
+      const auto iterations = std::min(interval, capIterations - epoch * interval);
+      const auto& incoming = emigrants[(epoch + 1) % 2];
+      auto& outgoing = emigrants[epoch % 2];
+
+      pool.parallelFor(islands, 1, [&](size_t, size_t begin, size_t end)
+        {
+          const randomGenerators::DefaultRandomEngine::ThreadStateGuard guard;
+          for (auto i = begin; i < end; ++i)
+          {
+            auto& island = population[i];
+
+            // adopt the fresh discovery of the previous island of the ring
+            const auto& migrant = incoming[(i + islands - 1) % islands];
+            const auto adopted = migrant.fresh && costComparator(island.cost, migrant.cost);
+            if (adopted)
+            {
+              island.solution = migrant.solution;
+              island.cost = migrant.cost;
+            }
+
+            reseed(i, epoch + 1);
+            if (!adopted && options.stagnationEpochs && island.stagnant >= options.stagnationEpochs)
+            {
+              restart(island.solution);
+              island.cost = cost(island.solution);
+              island.stagnant = 0;
+            }
+
+            island.solution = hillClimbing(iterations, island.solution, randomNeighbour, costEvaluator);
+            const auto climbedCost = cost(island.solution);
+            const auto improved = adopted || costComparator(island.cost, climbedCost);
+            island.cost = climbedCost;
+            island.stagnant = improved ? 0 : island.stagnant + 1;
+
+            auto& slot = outgoing[i];
+            slot.fresh = improved;
+            if (improved)
+            {
+              slot.solution = island.solution;
+              slot.cost = island.cost;
+            }
+          }
+        }, options.threads);
+
+      // the islands are in order, so the first of equal costs wins on any number of threads
+      auto improved = false;
+      FOR(i, islands)
+      {
+        if (costComparator(bestCost, population[i].cost))
+        {
+          best = population[i].solution;
+          bestCost = population[i].cost;
+          improved = true;
+        }
+      }
+
+      if (improved)
+      {
+        observer.improved(epoch * interval + iterations, static_cast<double>(bestCost));
+        stopping.improved(static_cast<double>(bestCost));
+      }
+
+      if (stopping.evaluated(islands * iterations))
+      {
+        break;
+      }
+    }
+
+    return best;
+  }
+
+  namespace unitTest {
+    double islandClimbHill();
+  }
+}
+
+#endif // !__ISLAND_HILL_CLIMBING_H__
@@ -0,0 +1,34 @@
+#include <cassert>
+
+#include "../statistics/clock.h"
+#include "../utility/Defines.h"
+#include "ParticleSwarm.h"
+
+double stochastic::unitTest::particleSwarmMin()
+{
+  stochastic::ParticleSwarmOptions options;
+  options.particles = 16;
+
+  const auto result = stochastic::particleSwarm(
+    BENCHMARK_ITERATIONS / options.particles,                             // iterations: the same evaluations as the other algorithms
+    BENCHMARK_PROBLEM_SIZE,
+    stochastic::SearchSpace2D<double>(-5, 5),
+    [](const std::vector<double>& xi) {                                   // function to evaluate 
+      auto sum = 0.0;
+      for (size_t i = 0; i < xi.size(); ++i)
+      {
+        sum += (xi[i] * xi[i]);
+      }
+
+      return sum;
+    },
+    [](double oldOptimal, double valueToCheck) {                          // cost comparator function
+      return valueToCheck < oldOptimal;
+    },
+    options
+  );
+
+  // 1000 evaluations leave the swarm within about 1e-6 of the minimum (0)
+  assert(result < 1e-3);
+  return result;
+}
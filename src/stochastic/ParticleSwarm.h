@@ -0,0 +1,302 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: implementation of the particle swarm optimization algorithm
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __PARTICLE_SWARM_H__
+#define __PARTICLE_SWARM_H__
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "../utility/Concepts.h"
+#include "../utility/AlignedAllocator.h"
+#include "../random_generators/vectorGenerator.h"
+#include "../statistics/trace.h"
+#include "../utility/StoppingCriteria.h"
+#include "../statistics/convergence.h"
+
+#include "RandomSearch.h"
+#include "Population.h"
+
+namespace stochastic {
+
+  /*! \class ParticleSwarmOptions "ParticleSwarm.h"
+    * \brief The parameters of particleSwarm; the defaults are the constriction coefficients of Clerc & Kennedy.
+    * \ingroup stochastic
+    */
+  struct ParticleSwarmOptions
+  {
+    size_t particles = 64;/*!< the swarm size */
+    double inertia = 0.7298;/*!< w: how much of its velocity a particle keeps */
+    double cognitive = 1.49618;/*!< c1: the pull towards the particle's own best position */
+    double social = 1.49618;/*!< c2: the pull towards the swarm's best position */
+    double maxVelocity = 0.2;/*!< the largest velocity on an axis, relative to the search space length */
+    size_t threads = 1;/*!< the threads evaluating the objective; the objective must be callable concurrently when > 1 */
+  };
+
+
+  /*! \class Swarm "ParticleSwarm.h"
+    * \brief The particles, as a structure of arrays.
+    *
+    * Positions, velocities and personal best positions are separate aligned matrices with one row per
+    * particle, every row padded to a whole number of cache lines: the velocity / position update is a
+    * single flat loop over all the particles that the compiler vectorizes, and a particle's position
+    * is still contiguous, so it can be handed to the objective function as it is.
+    * \tparam Type - the data type used by the algorithm
+    * \ingroup stochastic
+    */
+  template <typename Type>
+  class Swarm
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param particles - the number of particles
+      * \param dimensions - the dimension of a position
+      */
+    Swarm(size_t particles, size_t dimensions) :
+      _particles(particles)
+    , _dimensions(dimensions)
+    , _stride(PopulationMatrix<Type>::strideOf(dimensions))
+    , _positions(particles * _stride, 0)
+    , _velocities(particles * _stride, 0)
+    , _bestPositions(particles * _stride, 0)
+    , _bestCosts(particles)
+    {
+      ;
+    }
+
+    //! the number of particles
+    size_t particles() const { return _particles; }
+
+    //! the dimension of a position
+    size_t dimensions() const { return _dimensions; }
+
+    //! the distance between two rows (dimensions rounded up to a cache line)
+    size_t stride() const { return _stride; }
+
+    //! the position of a particle
+    std::span<Type> position(size_t particle) { return { _positions.data() + particle * _stride, _dimensions }; }
+
+    //! the best position of a particle
+    std::span<Type> bestPosition(size_t particle) { return { _bestPositions.data() + particle * _stride, _dimensions }; }
+
+    //! the cost of the best position of a particle
+    Type& bestCost(size_t particle) { return _bestCosts[particle]; }
+
+    //! all the positions, rows of stride()
+    utility::AlignedVector<Type>& positions() { return _positions; }
+
+    //! all the velocities, rows of stride()
+    utility::AlignedVector<Type>& velocities() { return _velocities; }
+
+    //! all the best positions, rows of stride()
+    utility::AlignedVector<Type>& bestPositions() { return _bestPositions; }
+
+  protected:
+    size_t _particles;
+    size_t _dimensions;
+    size_t _stride;
+    utility::AlignedVector<Type> _positions;/*!< the current positions */
+    utility::AlignedVector<Type> _velocities;/*!< the velocities */
+    utility::AlignedVector<Type> _bestPositions;/*!< the personal best positions */
+    std::vector<Type> _bestCosts;/*!< the costs of the personal best positions */
+  };
+
+
+  /*!
+    * \brief Moves every particle: v = w v + c1 r1 (best - x) + c2 r2 (globalBest - x), then x += v.
+    *
+    * Branch free over whole rows (the padding lanes are updated too, they are never evaluated), so the
+    * loops vectorize; the velocities and the positions are clamped to the limits.
+    * \tparam Type - the data type used by the algorithm
+    *
+    * \param[in,out] swarm - the particles
+    * \param[in] globalBest - the best position of the swarm, one row (stride() values)
+    * \param[in] random - 2 x particles x stride() uniform numbers in [0, 1)
+    * \param[in] options - the coefficients
+    * \param[in] left - the lower bound of the search space
+    * \param[in] right - the upper bound of the search space
+    * \param[in] maxVelocity - the largest velocity on an axis
+    * \ingroup stochastic
+    */
+  template <typename Type>
+  void moveParticles(Swarm<Type>& swarm, const Type* globalBest, const Type* random, const ParticleSwarmOptions& options, Type left, Type right, Type maxVelocity)
+  {
+    TRACE_ZONE("particleSwarm/move");
+    const auto stride = swarm.stride();
+    const auto w = static_cast<Type>(options.inertia);
+    const auto c1 = static_cast<Type>(options.cognitive);
+    const auto c2 = static_cast<Type>(options.social);
+
+    FOR(p, swarm.particles())
+    {
+      // one row per particle; restrict tells the compiler the rows do not overlap, so the loop vectorizes
+      const auto row = p * stride;
+      Type* __restrict x = swarm.positions().data() + row;
+      Type* __restrict v = swarm.velocities().data() + row;
+      const Type* __restrict best = swarm.bestPositions().data() + row;
+      const Type* __restrict r1 = random + row;
+      const Type* __restrict r2 = random + swarm.particles() * stride + row;
+      const Type* __restrict g = globalBest;
+
+      for (size_t d = 0; d < stride; ++d)
+      {
+        // the clamps are selects on values (std::clamp / std::min return references, which defeats the vectorizer)
+        auto velocity = w * v[d] + c1 * r1[d] * (best[d] - x[d]) + c2 * r2[d] * (g[d] - x[d]);
+        velocity = velocity < -maxVelocity ? -maxVelocity : velocity;
+        velocity = velocity > maxVelocity ? maxVelocity : velocity;
+        auto moved = x[d] + velocity;
+        moved = moved < left ? left : moved;
+        moved = moved > right ? right : moved;
+        v[d] = velocity;
+        x[d] = moved;
+      }
+    }
+  }
+
+
+  /*!
+    * \brief The particle swarm optimization algorithm
+    * Algorithm: <br>
+    * - every particle moves with a velocity pulled towards its own best position and towards the best
+    *   position of the whole swarm, each pull weighted by a fresh random number per coordinate;
+    * - after every move all the particles are evaluated (in parallel if asked) and the best positions updated.
+    *
+    * The random numbers of a step are drawn in bulk by the calling thread, so the result only depends on
+    * the seed, not on the number of threads.
+    * \tparam Type - the data type used by the algorithm
+    * \tparam Position - the position type: any contiguous container of Type
+    * \tparam SearchSpace - the search space
+    * \tparam ObjectiveFunctionType - the type of the cost function; receives a std::span<const Type> or a std::vector<Type>
+    * \tparam CostComparatorFunction - the cost comparator function, true when the second cost is better
+    * \tparam Observer - the convergence observer (see statistics::NullObserver)
+    * \tparam Stopping - the stopping criteria (see utility::StoppingCriteria); one evaluation per particle and move
+    *
+    * \param[in] iterations - the number of swarm moves
+    * \param[in,out] position - storage for the position; its size is the input size. Holds the best position on return
+    * \param[in] searchSpace - the search space
+    * \param[in] objectiveFunction - the cost function
+    * \param[in] costComparator - the cost comparator
+    * \param[in] options - the swarm parameters
+    * \param[in] observer - notified of every improvement of the swarm's best cost
+    * \param[in] stopping - ends the search early; position holds the best position so far
+    *
+    * \return the best cost found
+    * \ingroup stochastic
+    */
+  template <typename Type, class Position, template <class> class SearchSpace, class ObjectiveFunctionType, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+    requires utility::ContiguousRangeOf<Position, Type>
+  Type particleSwarm(size_t iterations, Position& position, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, CostComparatorFunction costComparator,
+                     const ParticleSwarmOptions& options = ParticleSwarmOptions(), Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    const auto dimensions = std::ranges::size(position);
+    const auto particles = std::max<size_t>(options.particles, 1);
+    const auto left = searchSpace.left();
+    const auto right = searchSpace.right();
+    const auto maxVelocity = static_cast<Type>(searchSpace.length() * options.maxVelocity);
+
+    Swarm<Type> swarm(particles, dimensions);
+    const auto stride = swarm.stride();
+    auto& engine = randomGenerators::DefaultRandomEngine::bulk();
+
+    engine.fillUniform<Type>(swarm.positions(), left, right);
+    engine.fillUniform<Type>(swarm.velocities(), -maxVelocity, maxVelocity);
+    swarm.bestPositions() = swarm.positions();
+
+    std::vector<Type> costs(particles);
+    const auto threads = std::max<size_t>(options.threads, 1);
+    const auto evaluate = [&]()
+    {
+      evaluatePopulation<Type>(particles, [&](size_t p) { return swarm.position(p); }, objectiveFunction, std::span<Type>(costs), threads);
+    };
+
+    evaluate();
+    utility::AlignedVector<Type> globalBest(stride, 0);
+    size_t bestParticle = 0;
+    FOR(p, particles)
+    {
+      swarm.bestCost(p) = costs[p];
+      if (costComparator(costs[bestParticle], costs[p]))
+      {
+        bestParticle = p;
+      }
+    }
+    auto bestCost = costs[bestParticle];
+    std::copy_n(swarm.bestPosition(bestParticle).data(), stride, globalBest.data());
+    observer.improved(0, static_cast<double>(bestCost));
+    stopping.improved(static_cast<double>(bestCost));
+
+    utility::AlignedVector<Type> random(2 * particles * stride);
+    FOR(i, iterations)
+    {
+      // counts the previous evaluation of the swarm
+      if (stopping.evaluated(particles))
+      {
+        break;
+      }
+
+      engine.fillUniform<Type>(random, static_cast<Type>(0), static_cast<Type>(1));
+      moveParticles(swarm, globalBest.data(), random.data(), options, left, right, maxVelocity);
+      evaluate();
+
+      TRACE_ZONE("particleSwarm/bookkeeping");
+      auto improved = false;
+      FOR(p, particles)
+      {
+        if (costComparator(swarm.bestCost(p), costs[p]))
+        {
+          swarm.bestCost(p) = costs[p];
+          std::copy_n(swarm.position(p).data(), stride, swarm.bestPosition(p).data());
+
+          if (costComparator(bestCost, costs[p]))
+          {
+            bestCost = costs[p];
+            bestParticle = p;
+            improved = true;
+          }
+        }
+      }
+
+      if (improved)
+      {
+        std::copy_n(swarm.bestPosition(bestParticle).data(), stride, globalBest.data());
+        observer.improved(i, static_cast<double>(bestCost));
+        stopping.improved(static_cast<double>(bestCost));
+      }
+    }
+
+    std::copy_n(globalBest.data(), dimensions, std::ranges::data(position));
+    return bestCost;
+  }
+
+
+  /*!
+    * \brief The particle swarm optimization algorithm, on a std::vector<Type> position of problemSize
+    *
+    * See the overload above for the algorithm and the parameters.
+    * \param[in] problemSize - the input size
+    *
+    * \return the best cost found
+    * \ingroup stochastic
+    */
+  template <typename Type, template <class> class SearchSpace, class ObjectiveFunctionType, class CostComparatorFunction,
+            class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+  Type particleSwarm(size_t iterations, size_t problemSize, const SearchSpace<Type>& searchSpace, ObjectiveFunctionType objectiveFunction, CostComparatorFunction costComparator,
+                     const ParticleSwarmOptions& options = ParticleSwarmOptions(), Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+  {
+    std::vector<Type> position(problemSize);
+    return particleSwarm(iterations, position, searchSpace, objectiveFunction, costComparator, options, std::forward<Observer>(observer), std::forward<Stopping>(stopping));
+  }
+
+  namespace unitTest {
+    double particleSwarmMin();
+  }
+}
+
+#endif // !__PARTICLE_SWARM_H__
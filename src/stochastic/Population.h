@@ -0,0 +1,162 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: a population of candidate positions stored as one matrix, evaluated in parallel
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __POPULATION_H__
+#define __POPULATION_H__
+
+#include <algorithm>
+#include <concepts>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "../utility/AlignedAllocator.h"
+#include "../utility/ThreadPool.h"
+#include "../statistics/trace.h"
+
+namespace stochastic {
+
+  /*! \class PopulationMatrix "Population.h"
+    * \brief Candidate positions, one aligned row each.
+    *
+    * Every row is padded to a whole number of cache lines, so row loops start aligned and threads
+    * writing different rows never share a line. A row is contiguous, so it can be handed to the
+    * objective function as it is.
+    * \tparam Type - the data type used by the algorithm
+    * \ingroup stochastic
+    */
+  template <typename Type>
+  class PopulationMatrix
+  {
+  public:
+    //! the number of Type values of a row of the given dimension (rounded up to a cache line)
+    static size_t strideOf(size_t dimensions)
+    {
+      return (dimensions * sizeof(Type) + utility::CACHE_LINE_SIZE - 1) / utility::CACHE_LINE_SIZE * utility::CACHE_LINE_SIZE / sizeof(Type);
+    }
+
+    /*!
+      * \brief init c-tor
+      * \param rows - the number of candidates
+      * \param dimensions - the dimension of a position
+      */
+    PopulationMatrix(size_t rows = 0, size_t dimensions = 0) :
+      _rows(rows)
+    , _dimensions(dimensions)
+    , _stride(strideOf(dimensions))
+    , _data(rows * _stride, 0)
+    {
+      ;
+    }
+
+    //! the number of candidates
+    size_t rows() const { return _rows; }
+
+    //! the dimension of a position
+    size_t dimensions() const { return _dimensions; }
+
+    //! the distance between two rows
+    size_t stride() const { return _stride; }
+
+    //! a candidate position
+    std::span<Type> row(size_t index) { return { _data.data() + index * _stride, _dimensions }; }
+
+    //! a candidate position
+    std::span<const Type> row(size_t index) const { return { _data.data() + index * _stride, _dimensions }; }
+
+    //! all the rows, padding included
+    utility::AlignedVector<Type>& data() { return _data; }
+
+    //! all the rows, padding included
+    const utility::AlignedVector<Type>& data() const { return _data; }
+
+  protected:
+    size_t _rows;
+    size_t _dimensions;
+    size_t _stride;
+    utility::AlignedVector<Type> _data;/*!< rows x stride values */
+  };
+
+
+  /*!
+    * \brief Evaluates one position, as a span if the objective accepts it, otherwise through a copy in a std::vector
+    * \ingroup stochastic
+    */
+  template <typename Type, class ObjectiveFunctionType>
+  Type evaluatePosition(ObjectiveFunctionType& objectiveFunction, std::span<const Type> position, std::vector<Type>& scratch)
+  {
+    if constexpr (std::invocable<ObjectiveFunctionType&, std::span<const Type>>)
+    {
+      return objectiveFunction(position);
+    }
+    else
+    {
+      scratch.assign(position.begin(), position.end());
+      return objectiveFunction(scratch);
+    }
+  }
+
+
+  /*!
+    * \brief Evaluates a batch of positions on the shared thread pool (see utility::ThreadPool)
+    *
+    * The candidates are claimed in small chunks, so uneven evaluation times balance out. Every thread
+    * works on its own copy of the objective function (and of the scratch position); the costs only
+    * depend on the positions, never on the number of threads.
+    * \tparam Type - the data type used by the algorithm
+    * \tparam ObjectiveFunctionType - the type of the cost function; must be callable concurrently when threads > 1
+    * \tparam PositionFunction - size_t -> std::span<const Type>, the position of a candidate
+    *
+    * \param[in] count - the number of candidates
+    * \param[in] position - gives the position of a candidate
+    * \param[in] objectiveFunction - the cost function
+    * \param[out] costs - the costs, count values
+    * \param[in] threads - the number of threads
+    * \ingroup stochastic
+    */
+  template <typename Type, class ObjectiveFunctionType, class PositionFunction>
+  void evaluatePopulation(size_t count, PositionFunction position, const ObjectiveFunctionType& objectiveFunction, std::span<Type> costs, size_t threads)
+  {
+    TRACE_ZONE("population/objective");
+    threads = std::max<size_t>(threads, 1);
+    if (threads == 1)
+    {
+      auto objective = objectiveFunction;
+      std::vector<Type> scratch;
+      FOR(index, count)
+      {
+        costs[index] = evaluatePosition<Type>(objective, std::span<const Type>(position(index)), scratch);
+      }
+
+      return;
+    }
+
+    struct Scratch
+    {
+      std::optional<ObjectiveFunctionType> objective;
+      std::vector<Type> position;
+    };
+
+    auto& pool = utility::ThreadPool::shared();
+    utility::WorkerLocal<Scratch> scratch(pool);
+    pool.parallelFor(count, std::max<size_t>(count / (8 * threads), 1), [&](size_t, size_t begin, size_t end)
+      {
+        auto& local = scratch.local();
+        if (!local.objective)
+        {
+          local.objective.emplace(objectiveFunction);
+        }
+
+        for (auto index = begin; index < end; ++index)
+        {
+          costs[index] = evaluatePosition<Type>(*local.objective, std::span<const Type>(position(index)), local.position);
+        }
+      }, threads);
+  }
+}
+
+#endif // !__POPULATION_H__
@@ -0,0 +1,65 @@
+#include <cassert>
+#include <chrono>
+
+#include "../utility/Defines.h"
+#include "AdaptiveRandomSearch.h"
+#include "DifferentialEvolution.h"
+#include "hillClimbing.h"
+#include "Portfolio.h"
+
+double stochastic::unitTest::portfolioMin()
+{
+  using Position = std::vector<double>;
+
+  const auto sphere = [](const auto& xi) {                                // function to evaluate
+    auto sum = 0.0;
+    for (size_t i = 0; i < xi.size(); ++i)
+    {
+      sum += (xi[i] * xi[i]);
+    }
+
+    return sum;
+  };
+  const auto lower = [](double oldOptimal, double valueToCheck) {         // cost comparator function
+    return valueToCheck < oldOptimal;
+  };
+  const stochastic::SearchSpace2D<double> searchSpace(-5, 5);
+  const Position initial(BENCHMARK_PROBLEM_SIZE);
+
+  stochastic::Portfolio<Position> portfolio;
+  portfolio
+    .add([&](auto& lane, Position& position)
+      {
+        return stochastic::adaptiveRandomSearch(BENCHMARK_ITERATIONS, position, searchSpace, sphere, stochastic::randomGeneration2D<double, stochastic::SearchSpace2D>, lower,
+                                                0.05, 1.3, 3.0, 10, 30, randomGenerators::Distribution::UNIFORM, statistics::NullObserver(), lane);
+      }, initial)
+    .add([&](auto& lane, Position& position)
+      {
+        stochastic::DifferentialEvolutionOptions options;
+        options.population = 20;
+        return stochastic::differentialEvolution(BENCHMARK_ITERATIONS / options.population, position, searchSpace, sphere, lower, options, statistics::NullObserver(), lane);
+      }, initial)
+    .add([&](auto& lane, Position& position)
+      {
+        // a random coordinate moved by a random fraction of the search space
+        randomGenerators::generateRandomVector<double>(std::span<double>(position), searchSpace.left(), searchSpace.right(), randomGenerators::Distribution::UNIFORM);
+        position = stochastic::hillClimbing(BENCHMARK_ITERATIONS, position,
+          [&](Position& candidate) {
+            auto& engine = randomGenerators::DefaultRandomEngine::bulk();
+            candidate[stochastic::randomIndex(engine, candidate.size())] += (engine.unit() - 0.5) * 0.1 * searchSpace.length();
+          },
+          [&](const Position& candidate, const Position& current) { return sphere(candidate) < sphere(current); },
+          sphere, statistics::NullObserver(), lane);
+        return sphere(position);
+      }, initial);
+
+  // the first solver below 1e-6 cancels the others; none runs past 100 ms
+  utility::StoppingCriteria criteria;
+  criteria.targetCost(1e-6).timeLimit(std::chrono::milliseconds(100));
+
+  const auto result = portfolio.run(criteria).cost;
+
+  // the race ends at the 1e-6 target, or a little above it at the deadline
+  assert(result < 1e-3);
+  return result;
+}
@@ -0,0 +1,353 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: an algorithm portfolio - several solvers raced on their own threads, sharing the best solution
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __PORTFOLIO_H__
+#define __PORTFOLIO_H__
+
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "../utility/Defines.h"
+#include "../utility/StoppingCriteria.h"
+#include "../random_generators/vectorGenerator.h"
+
+namespace stochastic {
+
+  /*! \class Incumbent "Portfolio.h"
+    * \brief The best solution found by the solvers of a portfolio.
+    *
+    * The best cost is an atomic slot, read and improved lock free (a compare and swap loop), so the
+    * solvers can publish every improvement and peek at the others' progress cheaply. The solution
+    * itself is only offered when a solver returns, and is copied under a lock.
+    * \tparam Solution - the solution type
+    * \ingroup stochastic
+    */
+  template <class Solution>
+  class Incumbent
+  {
+  public:
+    //! the solver of an incumbent no solver offered yet
+    static const size_t NO_SOLVER = std::numeric_limits<size_t>::max();
+
+    /*!
+      * \brief init c-tor
+      * \param minimize - true when smaller costs are better
+      */
+    explicit Incumbent(bool minimize = true) :
+      _minimize(minimize)
+    , _cost(minimize ? std::numeric_limits<double>::infinity() : -std::numeric_limits<double>::infinity())
+    , _solutionCost(_cost.load())
+    {
+      ;
+    }
+
+    //! true when cost is strictly better than than
+    bool isBetter(double cost, double than) const
+    {
+      return _minimize ? cost < than : cost > than;
+    }
+
+    //! the best cost published so far (infinitely bad before the first one)
+    double cost() const
+    {
+      return _cost.load(std::memory_order_acquire);
+    }
+
+    /*!
+      * \brief Publishes a cost, lock free
+      * \param cost - the cost of a solution a solver accepted
+      * \return true when it is the new best cost
+      */
+    bool improve(double cost)
+    {
+      auto current = _cost.load(std::memory_order_relaxed);
+      while (isBetter(cost, current))
+      {
+        if (_cost.compare_exchange_weak(current, cost, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+          return true;
+        }
+      }
+
+      return false;
+    }
+
+    /*!
+      * \brief Offers a solution, kept when it is better than the one held
+      * \param cost - the cost of the solution
+      * \param solution - the solution
+      * \param solver - the index of the solver offering it
+      * \return true when the solution was kept
+      */
+    bool offer(double cost, const Solution& solution, size_t solver)
+    {
+      improve(cost);
+
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_solver != NO_SOLVER && !isBetter(cost, _solutionCost))
+      {
+        return false;
+      }
+
+      _solution = solution;
+      _solutionCost = cost;
+      _solver = solver;
+      return true;
+    }
+
+    //! the best solution offered (a copy)
+    Solution solution() const
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _solution;
+    }
+
+    //! the cost of solution()
+    double solutionCost() const
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _solutionCost;
+    }
+
+    //! the solver of solution(), NO_SOLVER when none was offered
+    size_t solver() const
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      return _solver;
+    }
+
+  protected:
+    bool _minimize;
+    std::atomic<double> _cost;/*!< the best cost published */
+
+    mutable std::mutex _mutex;/*!< guards the solution */
+    Solution _solution;
+    double _solutionCost;
+    size_t _solver = NO_SOLVER;
+  };
+
+
+  /*! \class PortfolioLane "Portfolio.h"
+    * \brief What a solver of a portfolio gets: its stopping criteria, wired to the other solvers.
+    *
+    * A lane is a stopping criteria itself (see utility::NeverStop): hand it to the templated searches
+    * and every improvement is published to the incumbent; the one reaching the target cost cancels
+    * all the solvers. The non templated searches (e.g. problems::tsp::twoOptMove) take criteria(),
+    * which stops on the same deadline, budget, target and cancellation, and report their final cost
+    * by returning it.
+    * \tparam Solution - the solution type
+    * \ingroup stochastic
+    */
+  template <class Solution>
+  class PortfolioLane
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param index - the index of the solver
+      * \param criteria - the stopping criteria of the solver; its cancellation is the portfolio's
+      * \param incumbent - the shared best solution
+      * \param cancel - stops every solver
+      */
+    PortfolioLane(size_t index, const utility::StoppingCriteria& criteria, Incumbent<Solution>& incumbent, std::stop_source cancel) :
+      _index(index)
+    , _criteria(criteria)
+    , _incumbent(incumbent)
+    , _cancel(std::move(cancel))
+    {
+      ;
+    }
+
+    //! see utility::StoppingCriteria::evaluated
+    bool evaluated(size_t count = 1)
+    {
+      return _criteria.evaluated(count);
+    }
+
+    //! see utility::StoppingCriteria::improved
+    void improved()
+    {
+      _criteria.improved();
+    }
+
+    //! publishes the cost; reaching the target cost stops every solver
+    void improved(double cost)
+    {
+      _criteria.improved(cost);
+      _incumbent.improve(cost);
+      if (_criteria.reason() == utility::StopReason::TARGET)
+      {
+        _cancel.request_stop();
+      }
+    }
+
+    //! the lane publishes every cost, so the searches always compute it
+    static constexpr bool hasTarget() { return true; }
+
+    //! true once the solver must stop
+    bool stopped() const { return _criteria.stopped(); }
+
+    //! the index of the solver in the portfolio
+    size_t index() const { return _index; }
+
+    //! the stopping criteria, for the searches that only take a utility::StoppingCriteria
+    utility::StoppingCriteria& criteria() { return _criteria; }
+
+    //! the shared best solution
+    const Incumbent<Solution>& incumbent() const { return _incumbent; }
+
+  protected:
+    size_t _index;
+    utility::StoppingCriteria _criteria;/*!< the lane's own copy: the counters are not shared */
+    Incumbent<Solution>& _incumbent;
+    std::stop_source _cancel;/*!< the portfolio's cancellation */
+  };
+
+
+  /*! \class PortfolioOptions "Portfolio.h"
+    * \brief How the solvers of a portfolio are raced.
+    * \ingroup stochastic
+    */
+  struct PortfolioOptions
+  {
+    bool minimize = true;/*!< true when smaller costs are better */
+    std::optional<uint64_t> seed;/*!< solver i runs with randomGenerators::mixSeed(seed, i); DefaultRandomEngine::seed() when empty */
+  };
+
+
+  /*! \class PortfolioResult "Portfolio.h"
+    * \brief The outcome of a portfolio run.
+    * \ingroup stochastic
+    */
+  template <class Solution>
+  struct PortfolioResult
+  {
+    Solution solution;/*!< the best solution returned */
+    double cost = 0;/*!< its cost */
+    size_t winner = Incumbent<Solution>::NO_SOLVER;/*!< the solver that returned it */
+    std::vector<double> costs;/*!< the cost returned by every solver */
+    std::vector<utility::StopReason> reasons;/*!< why every solver stopped (NONE: it ran to completion) */
+  };
+
+
+  /*! \class Portfolio "Portfolio.h"
+    * \brief Races several solvers of the same problem, each on its own thread, and keeps the best solution.
+    *
+    * When it is not known which algorithm (or configuration) wins on an instance, running them all
+    * concurrently gives the best of N at about the latency of the fastest: the first solver reaching the
+    * target cost cancels the others, and they all share the deadline and the evaluation budget of the
+    * criteria (every solver has its own budget).
+    *
+    * A solver is a double(PortfolioLane<Solution>& lane, Solution& solution): it runs until the lane stops
+    * it (or it is done), writes its best solution and returns its cost. Every solver runs with its own
+    * random engine seed, so a solver that is not cancelled gives the same result on every run.
+    * \tparam Solution - the solution type
+    * \ingroup stochastic
+    */
+  template <class Solution>
+  class Portfolio
+  {
+  public:
+    using Solver = std::function<double(PortfolioLane<Solution>& lane, Solution& solution)>;
+
+    /*!
+      * \brief init c-tor
+      * \param options - the race options
+      */
+    explicit Portfolio(const PortfolioOptions& options = PortfolioOptions()) :
+      _options(options)
+    {
+      ;
+    }
+
+    /*!
+      * \brief Adds a solver
+      * \param solver - the solver
+      * \param initial - the storage of the solver's solution (e.g. sized to the problem)
+      * \return the portfolio
+      */
+    Portfolio& add(Solver solver, const Solution& initial = Solution())
+    {
+      _solvers.push_back({ std::move(solver), initial });
+      return *this;
+    }
+
+    //! the number of solvers
+    size_t size() const { return _solvers.size(); }
+
+    /*!
+      * \brief Races the solvers until they are all done or stopped
+      * \param criteria - the stopping criteria of every solver; its cancellation token cancels the whole portfolio
+      * \return the best solution and what every solver did
+      */
+    PortfolioResult<Solution> run(const utility::StoppingCriteria& criteria) const
+    {
+      Incumbent<Solution> incumbent(_options.minimize);
+      std::stop_source cancel;
+      std::stop_callback external(criteria.cancellationToken(), [&cancel]() { cancel.request_stop(); });
+
+      auto laneCriteria = criteria;
+      laneCriteria.cancellation(cancel.get_token());
+
+      const auto seed = _options.seed ? *_options.seed : randomGenerators::DefaultRandomEngine::seed();
+      PortfolioResult<Solution> result;
+      result.costs.resize(_solvers.size());
+      result.reasons.resize(_solvers.size());
+
+      std::vector<std::thread> threads;
+      threads.reserve(_solvers.size());
+      FOR(s, _solvers.size())
+      {
+        threads.emplace_back([&, s]()
+          {
+            randomGenerators::DefaultRandomEngine::reseedThread(randomGenerators::mixSeed(seed, s));
+
+            PortfolioLane<Solution> lane(s, laneCriteria, incumbent, cancel);
+            lane.criteria().start();
+            auto solution = _solvers[s].initial;
+            const auto cost = _solvers[s].solver(lane, solution);
+
+            // the searches taking criteria() only report their cost now
+            lane.improved(cost);
+            incumbent.offer(cost, solution, s);
+            result.costs[s] = cost;
+            result.reasons[s] = lane.criteria().reason();
+          });
+      }
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+
+      result.solution = incumbent.solution();
+      result.cost = incumbent.solutionCost();
+      result.winner = incumbent.solver();
+      return result;
+    }
+
+  protected:
+    struct Entry
+    {
+      Solver solver;
+      Solution initial;
+    };
+
+    PortfolioOptions _options;
+    std::vector<Entry> _solvers;
+  };
+
+  namespace unitTest {
+    double portfolioMin();
+  }
+}
+
+#endif // !__PORTFOLIO_H__
@@ -11,7 +11,7 @@ double stochastic::unitTest::randomSearchMin()
     BENCHMARK_PROBLEM_SIZE,                                               // problem size
     BENCHMARK_ITERATIONS,                                                 // iterations
     stochastic::SearchSpace2D<double>(-5, 5),                             // search space
-    [](const std::vector<double>& xi) {                                   // function to evaluate 
+    [](const auto& xi) {                                                  // function to evaluate (generic: a std::array position for small sizes)
       auto sum = 0.0;
       for (int i = 0; i < xi.size(); ++i)
       {
@@ -20,7 +20,7 @@ double stochastic::unitTest::randomSearchMin()
 
       return sum;
     },
-    stochastic::randomGeneration2D<double, stochastic::SearchSpace2D>,    // random samples generator
+    stochastic::randomFill2D<double, stochastic::SearchSpace2D>,          // random samples generator (in place)
     [](double oldOptimal, double valueToCheck) {                          // cost comparator function
       return valueToCheck < oldOptimal;
     }
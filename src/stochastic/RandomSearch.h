@@ -12,7 +12,21 @@
 #ifndef __RANDOM_SEARCH_H__
 #define __RANDOM_SEARCH_H__
 
+#include <array>
+#include <concepts>
+#include <memory_resource>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <optional>
+
 #include "../random_generators/vectorGenerator.h"
+#include "../random_generators/quasiRandom.h"
+#include "../utility/Concepts.h"
+#include "../utility/FixedDimension.h"
+#include "../utility/StoppingCriteria.h"
+#include "../statistics/convergence.h"
 
 /*! \defgroup stochastic A group of stochastic algorithms */
 namespace stochastic
@@ -133,7 +147,241 @@ namespace stochastic
 	std::vector<Type> randomGeneration2D(size_t problemSize, SearchSpace<Type> searchSpace)
 	{
 		// call the random generator for the given size and space
-		return randomGenerators::generateRandomVector<Type, std::vector>(problemSize, searchSpace.left(), searchSpace.right(), randomGenerators::Distribution::UNIFORM);
+		return randomGenerators::generateRandomVector<Type>(problemSize, searchSpace.left(), searchSpace.right(), randomGenerators::Distribution::UNIFORM);
+	}
+
+
+/*!
+	* \brief Creates a random generation function (see randomGeneration2D) allocating its vectors from memory
+	* The vectors handed to the objective function are std::pmr::vector<Type>; with a utility::RunArena
+	* the ones released at every iteration are recycled by the arena's pool instead of the heap.
+	* \tparam Type: the number type used
+	*
+	* \param memory: the memory resource (e.g. utility::RunArena::resource())
+	*
+	* \return the random generation function
+	* \ingroup stochastic
+	*/
+	template <class Type, template <class> class SearchSpace>
+	auto arenaRandomGeneration2D(std::pmr::memory_resource* memory)
+	{
+		return [memory](size_t problemSize, const SearchSpace<Type>& searchSpace)
+		{
+			return randomGenerators::generateRandomVector<Type>(problemSize, searchSpace.left(), searchSpace.right(), randomGenerators::Distribution::UNIFORM, memory);
+		};
+	}
+
+
+/*!
+	* \brief Function to fill a preallocated position with values in the space of the searchSpace
+	* \tparam Type: the number type used
+	*
+	* \param out: the position to fill (any contiguous range of Type converts to it)
+	* \param searchSpace: the search space into which we generate
+	*
+	* \ingroup stochastic
+	*/
+	template <class Type, template <class> class SearchSpace>
+	void randomFill2D(std::type_identity_t<std::span<Type>> out, const SearchSpace<Type>& searchSpace)
+	{
+		randomGenerators::generateRandomVector<Type>(out, searchSpace.left(), searchSpace.right(), randomGenerators::Distribution::UNIFORM);
+	}
+
+
+/*! \class QuasiRandomFill2D
+	* \brief Fills the positions with the points of a low discrepancy sequence, scaled to the search space
+	* Use it as the random fill (or random generation) function of randomSearch: for the same number of
+	* objective evaluations the points cover the search space more evenly than i.i.d. uniform samples.
+	* The sequence is created on the first call, with the dimension of the position.
+	*
+	* To split one sequence across threads, give every thread its own block: first = thread * (samples / threads).
+	* randomSearch takes the fill by reference, so the runs given the same fill continue its sequence; a
+	* SobolSequence has SobolSequence::CAPACITY points, after which the fill starts over from first.
+	* \tparam Sequence: randomGenerators::SobolSequence or randomGenerators::HaltonSequence
+	* \ingroup stochastic
+	*/
+	template <class Sequence>
+	class QuasiRandomFill2D
+	{
+	public:
+
+		/*!
+			* \brief init c-tor
+			* \param scrambleSeed: the scrambling of the sequence (see the sequence); vary it between independent runs
+			* \param first: the index of the first point used
+			*/
+		explicit QuasiRandomFill2D(uint64_t scrambleSeed = 0, uint64_t first = 0) :
+			_scrambleSeed(scrambleSeed)
+		, _first(first)
+		{
+			;
+		}
+
+		/*!
+			* \brief fills the position with the next point
+			* \param out: the position
+			* \param searchSpace: the search space into which we generate
+			*/
+		template <class Type, template <class> class SearchSpace>
+		void operator()(std::span<Type> out, const SearchSpace<Type>& searchSpace)
+		{
+			if (!_sequence || _sequence->dimensions() != out.size())
+			{
+				_sequence.emplace(out.size(), _scrambleSeed);
+				_sequence->skipTo(_first);
+			}
+
+			if (!_sequence->next(out))
+			{
+				_sequence->skipTo(_first);
+				_sequence->next(out);
+			}
+
+			const auto left = searchSpace.left();
+			const auto length = searchSpace.right() - left;
+			for (auto& value : out)
+			{
+				value = left + value * length;
+			}
+		}
+
+		/*!
+			* \brief generates the next point
+			* \param problemSize: the vector dimension to generate
+			* \param searchSpace: the search space into which we generate
+			*
+			* \return the generated vector
+			*/
+		template <class Type, template <class> class SearchSpace>
+		std::vector<Type> operator()(size_t problemSize, const SearchSpace<Type>& searchSpace)
+		{
+			std::vector<Type> point(problemSize);
+			(*this)(std::span<Type>(point), searchSpace);
+			return point;
+		}
+
+	protected:
+		uint64_t _scrambleSeed;/*!< the scrambling of the sequence */
+		uint64_t _first;/*!< the index of the first point */
+		std::optional<Sequence> _sequence;/*!< the sequence, once the dimension is known */
+	};
+
+	//! Sobol points for randomSearch (see QuasiRandomFill2D)
+	using SobolFill2D = QuasiRandomFill2D<randomGenerators::SobolSequence>;
+
+	//! scrambled Halton points for randomSearch (see QuasiRandomFill2D)
+	using HaltonFill2D = QuasiRandomFill2D<randomGenerators::HaltonSequence>;
+
+
+	/*!
+		* \brief The random search algorithm, sampling into a caller provided position
+		* The position is reused for every sample, so the loop does not allocate.
+		* \tparam Type: the number type used for the random search
+		* \tparam Position: any contiguous range of Type (std::vector with any allocator, std::array, std::span)
+		* \tparam SearchSpace: the search space used by the algorithm
+		* \tparam FunctionToOptimize: the prototype of the function to optimize; receives the Position
+		* \tparam RandomFillFunction: void(std::span<Type> out, const SearchSpace<Type>&), e.g. randomFill2D
+		* \tparam CostComparatorFunction: the prototype of the cost comparator
+		* \tparam Observer: the convergence observer (see statistics::NullObserver)
+		* \tparam Stopping: the stopping criteria (see utility::StoppingCriteria); one evaluation per iteration
+		*
+		* \param initialOptimal: initial optimal value
+		* \param inputs: the position buffer; its size is the problem size
+		* \param numIterations: the number of iterations used to reach the solution
+		* \param searchSpace: the search space object
+		* \param function: the function whose solution we are computing
+		* \param randomFill: fills the position with a new sample; a stateful fill (e.g. SobolFill2D) continues from the previous search
+		* \param acceptNewCost: function to compare and accept costs
+		* \param observer: notified of every accepted cost
+		* \param stopping: ends the search early; the best cost so far is returned
+		*
+		* \return the solution
+		* \ingroup stochastic
+		*/
+	template <typename Type, class Position, template <class> class SearchSpace, class FunctionToOptimize, class RandomFillFunction, class CostComparatorFunction,
+		class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+		requires utility::ContiguousRangeOf<Position, Type>
+	Type randomSearch(Type initialOptimal, Position& inputs, size_t numIterations, SearchSpace<Type> searchSpace, FunctionToOptimize function, RandomFillFunction&& randomFill, CostComparatorFunction acceptNewCost,
+		Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+	{
+		Type optimal = initialOptimal;
+
+		for (size_t i = 0; i < numIterations; ++i)
+		{
+			randomFill(utility::asSpan(inputs), searchSpace);
+
+			Type cost = function(inputs);
+			if (acceptNewCost(optimal, cost))
+			{
+				optimal = cost;
+				observer.improved(i, static_cast<double>(cost));
+				stopping.improved(static_cast<double>(cost));
+			}
+
+			if (stopping.evaluated())
+			{
+				break;
+			}
+		}
+
+		return optimal;
+	}
+
+
+	/*!
+		* \brief The random search algorithm, for in place generators (e.g. randomFill2D)
+		* Samples into a single position of problemSize instead of a new vector per iteration. Up to
+		* utility::MAX_FIXED_DIMENSION the position is a std::array<Type, problemSize> on the stack, selected at
+		* compile time (see utility::dispatchDimension), when the function accepts one (a generic lambda or a
+		* std::span<const Type>); otherwise it is a std::vector<Type>.
+		* \tparam Type: the number type used for the random search
+		* \tparam SearchSpace: the search space used by the algorithm
+		* \tparam FunctionToOptimize: the prototype of the function to optimize; receives the position
+		* \tparam RandomFillFunction: void(std::span<Type> out, const SearchSpace<Type>&)
+		* \tparam CostComparatorFunction: the prototype of the cost comparator
+		* \tparam Observer: the convergence observer (see statistics::NullObserver)
+		* \tparam Stopping: the stopping criteria (see utility::StoppingCriteria); one evaluation per iteration
+		*
+		* \param initialOptimal: initial optimal value
+		* \param problemSize: the dimension of the vector to scan
+		* \param numIterations: the number of iterations used to reach the solution
+		* \param searchSpace: the search space object
+		* \param function: the function whose solution we are computing
+		* \param randomFill: fills the position with a new sample; a stateful fill (e.g. SobolFill2D) continues from the previous search
+		* \param acceptNewCost: function to compare and accept costs
+		* \param observer: notified of every accepted cost
+		* \param stopping: ends the search early; the best cost so far is returned
+		*
+		* \return the solution
+		* \ingroup stochastic
+		*/
+	template <typename Type, template <class> class SearchSpace, class FunctionToOptimize, class RandomFillFunction, class CostComparatorFunction,
+		class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+		requires std::invocable<RandomFillFunction&, std::span<Type>, const SearchSpace<Type>&>
+	Type randomSearch(Type initialOptimal, size_t problemSize, size_t numIterations, SearchSpace<Type> searchSpace, FunctionToOptimize function, RandomFillFunction&& randomFill, CostComparatorFunction acceptNewCost,
+		Observer&& observer = Observer(), Stopping&& stopping = Stopping())
+	{
+		const auto dynamic = [&]()
+		{
+			std::vector<Type> inputs(problemSize);
+			return randomSearch(initialOptimal, inputs, numIterations, searchSpace, function, randomFill, acceptNewCost, std::forward<Observer>(observer), std::forward<Stopping>(stopping));
+		};
+
+		return utility::dispatchDimension(problemSize,
+			[&](auto dimension)
+			{
+				using Inputs = std::array<Type, decltype(dimension)::value>;
+				if constexpr (std::invocable<FunctionToOptimize&, Inputs&>)
+				{
+					Inputs inputs{};
+					return randomSearch(initialOptimal, inputs, numIterations, searchSpace, function, randomFill, acceptNewCost, std::forward<Observer>(observer), std::forward<Stopping>(stopping));
+				}
+				else
+				{
+					return dynamic();
+				}
+			},
+			dynamic);
 	}
 
 
@@ -146,6 +394,8 @@ namespace stochastic
 		* \tparam FunctionToOptimize: the prototype of the function to optimize
 		* \tparam RandomGenerationFunction: the prototype of the random numbers generator
 		* \tparam CostComparatorFunction: the prototype of the cost comparator
+		* \tparam Observer: the convergence observer (see statistics::NullObserver)
+		* \tparam Stopping: the stopping criteria (see utility::StoppingCriteria); one evaluation per iteration
 		*
 		* \param initialOptimal: initial optimal value
 		* \param problemSize: the dimension of the vector to scan
@@ -154,12 +404,16 @@ namespace stochastic
 		* \param function: the function whose solution we are computing
 		* \param randomGenerationFunction: the random numbers generator
 		* \param acceptNewCost: function to compare and accept costs
+		* \param observer: notified of every accepted cost
+		* \param stopping: ends the search early; the best cost so far is returned
 		*
 		* \return the solution
 		* \ingroup stochastic
 		*/
-	template <typename Type, template <class> class SearchSpace, class FunctionToOptimize, class RandomGenerationFunction, class CostComparatorFunction>
-	Type randomSearch(Type initialOptimal, size_t problemSize, size_t numIterations, SearchSpace<Type> searchSpace, FunctionToOptimize function, RandomGenerationFunction randomGenerationFunction, CostComparatorFunction acceptNewCost)
+	template <typename Type, template <class> class SearchSpace, class FunctionToOptimize, class RandomGenerationFunction, class CostComparatorFunction,
+		class Observer = statistics::NullObserver, class Stopping = utility::NeverStop>
+	Type randomSearch(Type initialOptimal, size_t problemSize, size_t numIterations, SearchSpace<Type> searchSpace, FunctionToOptimize function, RandomGenerationFunction&& randomGenerationFunction, CostComparatorFunction acceptNewCost,
+		Observer&& observer = Observer(), Stopping&& stopping = Stopping())
 	{
 		// the result to be outputted
 		Type optimal = initialOptimal;
@@ -179,6 +433,14 @@ namespace stochastic
 			if (acceptNewCost(optimal, cost))
 			{
 				optimal = cost;
+				observer.improved(i, static_cast<double>(cost));
+				stopping.improved(static_cast<double>(cost));
+			}
+
+			// deadline, budget, target, ... - keep the best so far
+			if (stopping.evaluated())
+			{
+				break;
 			}
 		}
 
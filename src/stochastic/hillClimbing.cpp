@@ -6,7 +6,7 @@ double stochastic::unitTest::climbHill()
 {
   static const size_t oneMaxSize = 1000;
 
-  auto bitstring = randomGenerators::generateRandomVector<int, std::vector, short>(oneMaxSize, 0, 1, randomGenerators::Distribution::UNIFORM);
+  auto bitstring = randomGenerators::generateRandomVector<int, short>(oneMaxSize, 0, 1, randomGenerators::Distribution::UNIFORM);
   auto costCalculator = [](const std::vector<short>& bitstring) -> size_t
   {
     return std::count_if(bitstring.begin(), bitstring.end(), [](int i) { return i != 0; });    
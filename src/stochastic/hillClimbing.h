@@ -8,9 +8,13 @@
 #ifndef __HILL_CLIMBING_H__
 #define __HILL_CLIMBING_H__
 
+#include <type_traits>
 #include <vector>
 
 #include "../utility/Defines.h"
+#include "../utility/Concepts.h"
+#include "../utility/StoppingCriteria.h"
+#include "../statistics/convergence.h"
 
 namespace stochastic {
 
@@ -26,30 +30,74 @@ namespace stochastic {
     * \tparam Solution - the solution type;
     * \tparam GenerateRandomNeighbourFunction - the type of the function needed to generate a random neighbour;
     * \tparam CostEvaluatorFunction - the type of the function needed to evaluate the costs;
+    * \tparam CostFunction - double(const Solution&), the cost reported to the observer and the stopping criteria; evaluated once per
+    *                        accepted neighbour, and only when there is an observer or a stopping criterion;
+    * \tparam Observer - the convergence observer (see statistics::NullObserver);
+    * \tparam Stopping - the stopping criteria (see utility::StoppingCriteria); one evaluation per iteration. Only strictly better
+    *                    neighbours count as improvements: an accepted neighbour with the cost of the current solution (an evaluator
+    *                    accepting ties) is a move along a plateau and does not reset the stagnation;
     *
     * \param[in] capIterations - the number of iterations to reach a solution;
     * \param[in] initialSolution - initial solution of the problem;
     * \param[in] randomNeighbour - the function that selects the neighbour to evaluate;
     * \param[in] costEvaluator - the function that evaluates the two solutions considered;
+    * \param[in] cost - the cost reported to the observer;
+    * \param[in] observer - notified of the cost of every accepted neighbour;
+    * \param[in] stopping - ends the search early; the current solution is returned;
     *
     * \return the solution;
     * \ingroup stochastic
     * \note <b>the implementation might be suboptimal if Solution is a vector of an important size.</b>
     */
-  template <class Solution, class GenerateRandomNeighbourFunction, class CostEvaluatorFunction>
-  Solution hillClimbing(size_t capIterations, const Solution& initialSolution, GenerateRandomNeighbourFunction randomNeighbour, CostEvaluatorFunction costEvaluator)
+  template <class Solution, class GenerateRandomNeighbourFunction, class CostEvaluatorFunction, class CostFunction, class Observer, class Stopping = utility::NeverStop>
+  Solution hillClimbing(size_t capIterations, const Solution& initialSolution, GenerateRandomNeighbourFunction randomNeighbour, CostEvaluatorFunction costEvaluator,
+                        CostFunction cost, Observer&& observer, Stopping&& stopping = Stopping())
   {
+    // a NullObserver never needs the cost, NeverStop never needs to tell improvements from plateau moves
+    constexpr auto observed = !std::is_same_v<std::remove_cvref_t<Observer>, statistics::NullObserver>;
+    constexpr auto stoppable = !std::is_same_v<std::remove_cvref_t<Stopping>, utility::NeverStop>;
+
+    // the cost of an accepted solution, when someone needs it
+    const auto costOf = [&](const Solution& solution)
+    {
+      if constexpr (observed || stoppable)
+      {
+        return static_cast<double>(cost(solution));
+      }
+      else
+      {
+        return 0.0;
+      }
+    };
+
+    // reports an accepted solution; the stopping criteria only hear of strict improvements
+    const auto accepted = [&](size_t iteration, double solutionCost, bool improved)
+    {
+      if constexpr (observed)
+      {
+        observer.improved(iteration, solutionCost);
+      }
+      if (improved)
+      {
+        stopping.improved(solutionCost);
+      }
+    };
+
     // in an effort to keep this implementation as general as possible
     // user must provide the initial solution function
     // problemSpace will yield out of the currentSoltution's dimension
     //! solution should contain the parameters and the objective function result;
-    auto currentSolution = initialSolution;
+    auto currentSolution = utility::copyWithAllocator(initialSolution);
 
     // Declare the candidate here - this helps with avoiding the costly creation and allocation
     // of std::vectors in the inner loop;
     // candidate will have the same dimension as the currentSolution and that will 
-    // be the project space;
-    auto candidate = currentSolution;
+    // be the project space; an allocator-aware solution (e.g. a std::pmr::vector
+    // from a run arena) keeps the candidate in the same memory;
+    auto candidate = utility::copyWithAllocator(currentSolution);
+
+    auto currentCost = costOf(currentSolution);
+    accepted(0, currentCost, true);
 
     // algorithm loop
     FOR(ite, capIterations)
@@ -62,20 +110,45 @@ namespace stochastic {
       // to be changed
       if (costEvaluator(candidate, currentSolution))
       {
+        // an evaluator accepting ties (>=) also moves along plateaus: the neighbour improves only if its cost differs
+        const auto candidateCost = costOf(candidate);
+        const auto improved = candidateCost != currentCost;
+
         // move to the neighbour as it presents better results
         currentSolution = candidate;
+        currentCost = candidateCost;
+        accepted(ite, currentCost, improved);
       }
       else
       {
         // reset the neighbour
         candidate = currentSolution;
       }
+
+      // deadline, budget, target, ... - keep the current solution
+      if (stopping.evaluated())
+      {
+        break;
+      }
     }
 
     // the best solution found
     return currentSolution;
   }
 
+
+  /*!
+    * \brief Hill climbing using random neighbours, without convergence reporting
+    *
+    * See the overload above for the algorithm and the parameters.
+    * \ingroup stochastic
+    */
+  template <class Solution, class GenerateRandomNeighbourFunction, class CostEvaluatorFunction>
+  Solution hillClimbing(size_t capIterations, const Solution& initialSolution, GenerateRandomNeighbourFunction randomNeighbour, CostEvaluatorFunction costEvaluator)
+  {
+    return hillClimbing(capIterations, initialSolution, randomNeighbour, costEvaluator, [](const Solution&) { return 0.0; }, statistics::NullObserver());
+  }
+
   namespace unitTest {
     double climbHill();
   }
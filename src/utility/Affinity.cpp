@@ -0,0 +1,101 @@
+#include <set>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <fstream>
+#include <string>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "Defines.h"
+#include "Parallel.h"
+#include "Affinity.h"
+
+std::vector<size_t> utility::physicalCoreProcessors()
+{
+  std::vector<size_t> processors;
+
+#if defined(_WIN32)
+  DWORD length = 0;
+  GetLogicalProcessorInformation(nullptr, &length);
+  std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> information(length / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+  if (!information.empty() && GetLogicalProcessorInformation(information.data(), &length))
+  {
+    for (auto& entry : information)
+    {
+      if (entry.Relationship != RelationProcessorCore)
+      {
+        continue;
+      }
+
+      // the lowest logical processor of the core
+      for (size_t bit = 0; bit < sizeof(ULONG_PTR) * 8; ++bit)
+      {
+        if (entry.ProcessorMask & (ULONG_PTR(1) << bit))
+        {
+          processors.push_back(bit);
+          break;
+        }
+      }
+    }
+  }
+#elif defined(__linux__)
+  // (package, core) identifies a physical core; cpus are listed in increasing order, so the first one found is kept
+  std::set<std::pair<int, int>> cores;
+  FOR(cpu, hardwareThreads())
+  {
+    const auto topology = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+    std::ifstream packageFile(topology + "physical_package_id");
+    std::ifstream coreFile(topology + "core_id");
+    int package = 0;
+    int core = 0;
+    if (!(packageFile >> package) || !(coreFile >> core))
+    {
+      processors.clear();
+      break;
+    }
+
+    if (cores.insert({ package, core }).second)
+    {
+      processors.push_back(cpu);
+    }
+  }
+#endif
+
+  if (processors.empty())
+  {
+    FOR(cpu, hardwareThreads())
+    {
+      processors.push_back(cpu);
+    }
+  }
+
+  return processors;
+}
+
+bool utility::pinCurrentThread(size_t processor)
+{
+#if defined(_WIN32)
+  if (processor >= sizeof(DWORD_PTR) * 8)
+  {
+    return false;
+  }
+  return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << processor) != 0;
+#elif defined(__linux__)
+  if (processor >= CPU_SETSIZE)
+  {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(processor, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,37 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: processor topology and thread pinning
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __AFFINITY_H__
+#define __AFFINITY_H__
+
+#include <cstddef>
+#include <vector>
+
+namespace utility
+{
+  /*!
+    * \brief One logical processor per physical core (the first hyper-thread of each core).
+    *
+    * Pinning one worker to each of these keeps two workers from sharing a core's execution units.
+    * Falls back to every logical processor when the topology is unknown.
+    * \return the logical processor indices, at least one
+    * \ingroup utility
+    */
+  std::vector<size_t> physicalCoreProcessors();
+
+
+  /*!
+    * \brief Restricts the calling thread to a logical processor.
+    *
+    * \param processor - the logical processor index
+    *
+    * \return true on success; false when pinning is not supported (the thread is left unpinned)
+    * \ingroup utility
+    */
+  bool pinCurrentThread(size_t processor);
+}
+
+#endif // !__AFFINITY_H__
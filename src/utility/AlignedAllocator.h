@@ -0,0 +1,79 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: an allocator returning over-aligned memory (cache line / SIMD register friendly)
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __ALIGNED_ALLOCATOR_H__
+#define __ALIGNED_ALLOCATOR_H__
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace utility
+{
+  //! the default alignment: a cache line, which also fits an AVX-512 register
+  static const size_t CACHE_LINE_SIZE = 64;
+
+  /*! \class AlignedAllocator "AlignedAllocator.h"
+    * \brief Standard allocator whose allocations are aligned to Alignment bytes.
+    * \tparam Type - the allocated type
+    * \tparam Alignment - the alignment in bytes (power of 2)
+    * \ingroup utility
+    */
+  template <class Type, size_t Alignment = CACHE_LINE_SIZE>
+  class AlignedAllocator
+  {
+  public:
+    using value_type = Type;
+
+    template <class Other>
+    struct rebind
+    {
+      using other = AlignedAllocator<Other, Alignment>;
+    };
+
+    //! default c-tor
+    AlignedAllocator() noexcept = default;
+
+    //! converting c-tor
+    template <class Other>
+    AlignedAllocator(const AlignedAllocator<Other, Alignment>&) noexcept
+    {
+      ;
+    }
+
+    /*!
+      * \brief allocates aligned storage for count elements
+      * \param count - the number of elements
+      * \return the storage
+      */
+    Type* allocate(size_t count)
+    {
+      return static_cast<Type*>(::operator new(count * sizeof(Type), std::align_val_t(Alignment)));
+    }
+
+    /*!
+      * \brief releases storage obtained from allocate()
+      * \param pointer - the storage
+      * \param count - the number of elements
+      */
+    void deallocate(Type* pointer, size_t count) noexcept
+    {
+      ::operator delete(pointer, count * sizeof(Type), std::align_val_t(Alignment));
+    }
+
+    template <class Other>
+    bool operator==(const AlignedAllocator<Other, Alignment>&) const noexcept
+    {
+      return true;
+    }
+  };
+
+  //! a std::vector whose storage is aligned to Alignment bytes
+  template <class Type, size_t Alignment = CACHE_LINE_SIZE>
+  using AlignedVector = std::vector<Type, AlignedAllocator<Type, Alignment>>;
+}
+
+#endif // !__ALIGNED_ALLOCATOR_H__
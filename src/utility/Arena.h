@@ -0,0 +1,91 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: run-scoped scratch memory (std::pmr compatible)
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __ARENA_H__
+#define __ARENA_H__
+
+#include <cstddef>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+namespace utility
+{
+  //! a std::vector allocating from a std::pmr::memory_resource (e.g. RunArena::resource())
+  template <class Type>
+  using ArenaVector = std::pmr::vector<Type>;
+
+  /*! \class RunArena "Arena.h"
+    * \brief Scratch memory for one optimization run.
+    *
+    * A monotonic region takes its memory from the upstream resource in a few large blocks;
+    * an unsynchronized pool on top of it recycles the buffers released during the run
+    * (vectors that are created and destroyed in a loop do not grow the region).
+    * Everything goes back to the upstream in one go when the arena is released or destroyed.
+    *
+    * The arena is not thread safe: use one arena per thread / per run.
+    * \ingroup utility
+    */
+  class RunArena
+  {
+  public:
+    //! the size of the first block taken from the upstream resource
+    static const size_t DEFAULT_INITIAL_SIZE = 64 * 1024;
+
+    /*!
+      * \brief init c-tor
+      * \param initialSize - the size of the first block taken from upstream
+      * \param upstream - where the blocks come from
+      */
+    explicit RunArena(size_t initialSize = DEFAULT_INITIAL_SIZE, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) :
+      _region(initialSize, upstream)
+    , _pool(&_region)
+    {
+      ;
+    }
+
+    /*!
+      * \brief init c-tor, using a caller provided buffer (e.g. on the stack) before going upstream
+      * \param buffer - the first block
+      * \param upstream - where the next blocks come from
+      */
+    explicit RunArena(std::span<std::byte> buffer, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) :
+      _region(buffer.data(), buffer.size(), upstream)
+    , _pool(&_region)
+    {
+      ;
+    }
+
+    RunArena(const RunArena&) = delete;
+    RunArena& operator=(const RunArena&) = delete;
+
+    /*!
+      * \brief the resource the run allocates from
+      * \return the memory resource
+      */
+    std::pmr::memory_resource* resource()
+    {
+      return &_pool;
+    }
+
+    /*!
+      * \brief gives all the memory back to the upstream resource
+      *
+      * Every container allocated from the arena must be gone (or never used again).
+      */
+    void release()
+    {
+      _pool.release();
+      _region.release();
+    }
+
+  protected:
+    std::pmr::monotonic_buffer_resource _region;
+    std::pmr::unsynchronized_pool_resource _pool;
+  };
+}
+
+#endif // !__ARENA_H__
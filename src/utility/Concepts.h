@@ -0,0 +1,90 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: concepts describing the containers accepted by the algorithms
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __CONCEPTS_H__
+#define __CONCEPTS_H__
+
+#include <cstddef>
+#include <concepts>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+namespace utility
+{
+  /*!
+    * \brief A contiguous, sized range of Type elements.
+    *
+    * std::vector with any allocator, std::array, std::span and plain arrays all qualify,
+    * so the algorithms can run on memory they do not own (aligned, arena or mapped buffers).
+    * \ingroup utility
+    */
+  template <class Range, class Type>
+  concept ContiguousRangeOf = std::ranges::contiguous_range<Range> && std::ranges::sized_range<Range>
+                           && std::same_as<std::ranges::range_value_t<Range>, Type>;
+
+  /*!
+    * \brief A contiguous container of Type that can be created with a given number of elements.
+    *
+    * This is what the algorithms need for the positions they allocate themselves.
+    * \ingroup utility
+    */
+  template <class Container, class Type>
+  concept SizedContainerOf = ContiguousRangeOf<Container, Type> && std::constructible_from<Container, size_t>;
+
+  /*!
+    * \brief A contiguous container of Type the algorithms can use as a position.
+    *
+    * Unlike a view (std::span), a copy of a position owns its elements, so the algorithms
+    * can derive their scratch positions from the one they receive.
+    * \ingroup utility
+    */
+  template <class Container, class Type>
+  concept PositionOf = ContiguousRangeOf<Container, Type> && std::copy_constructible<Container> && !std::ranges::view<Container>;
+
+  /*!
+    * \brief Views any contiguous range as a span of its elements.
+    * \tparam Range - the range type
+    *
+    * \param range - the range to view
+    *
+    * \return a span over the range's elements
+    * \ingroup utility
+    */
+  template <std::ranges::contiguous_range Range>
+  auto asSpan(Range&& range)
+  {
+    return std::span(std::ranges::data(range), std::ranges::size(range));
+  }
+
+  /*!
+    * \brief Copies a container, keeping the allocator of the original.
+    *
+    * A plain copy asks the allocator for the resource of the copy and std::pmr containers
+    * fall back to the default resource; scratch copies of a position should live in the same
+    * memory (e.g. the run arena) as the position itself.
+    * \tparam Container - the container type
+    *
+    * \param container - the container to copy
+    *
+    * \return the copy
+    * \ingroup utility
+    */
+  template <class Container>
+  Container copyWithAllocator(const Container& container)
+  {
+    if constexpr (requires { container.get_allocator(); })
+    {
+      return Container(container, container.get_allocator());
+    }
+    else
+    {
+      return container;
+    }
+  }
+}
+
+#endif // !__CONCEPTS_H__
@@ -0,0 +1,119 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: compile time problem sizes - dispatching a runtime size to std::array code, with a runtime fallback
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __FIXED_DIMENSION_H__
+#define __FIXED_DIMENSION_H__
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace utility
+{
+  //! the largest problem size dispatched to a compile time (std::array) specialization
+  static const size_t MAX_FIXED_DIMENSION = 8;
+
+  //! the compile time size of a container: N for std::array<Type, N> and std::span<Type, N>, std::dynamic_extent otherwise
+  template <class Container>
+  struct StaticExtent : std::integral_constant<size_t, std::dynamic_extent> {};
+
+  template <class Type, size_t N>
+  struct StaticExtent<std::array<Type, N>> : std::integral_constant<size_t, N> {};
+
+  template <class Type, size_t N>
+  struct StaticExtent<std::span<Type, N>> : std::integral_constant<size_t, N> {};
+
+  //! the tag of the runtime size code path (see dispatchDimension)
+  using DynamicDimension = std::integral_constant<size_t, std::dynamic_extent>;
+
+  //! a std::array<Type, Extent>, or a std::vector<Type> for std::dynamic_extent
+  template <class Type, size_t Extent>
+  using DimensionArray = std::conditional_t<Extent == std::dynamic_extent, std::vector<Type>, std::array<Type, Extent>>;
+
+  /*!
+    * \brief Creates a DimensionArray of the given size
+    * \tparam Type - the element type
+    * \tparam Extent - the compile time size, or std::dynamic_extent
+    *
+    * \param size - the size; must be Extent for a fixed size
+    * \param value - the value of every element
+    *
+    * \return the array (or vector)
+    * \ingroup utility
+    */
+  template <class Type, size_t Extent>
+  DimensionArray<Type, Extent> makeDimensionArray(size_t size, Type value = Type())
+  {
+    if constexpr (Extent == std::dynamic_extent)
+    {
+      return std::vector<Type>(size, value);
+    }
+    else
+    {
+      DimensionArray<Type, Extent> result;
+      result.fill(value);
+      return result;
+    }
+  }
+
+  /*!
+    * \brief Calls function(std::integral_constant<size_t, I>()) for I = 0 .. N - 1, unrolled at compile time
+    * \ingroup utility
+    */
+  template <size_t N, class Function>
+  void unroll(Function&& function)
+  {
+    [&]<size_t... I>(std::index_sequence<I...>)
+    {
+      (function(std::integral_constant<size_t, I>()), ...);
+    }(std::make_index_sequence<N>());
+  }
+
+  template <size_t N, size_t Max, class FixedFunction, class DynamicFunction>
+  decltype(auto) dispatchDimensionFrom(size_t dimension, FixedFunction& fixed, DynamicFunction& dynamic)
+  {
+    if constexpr (N > Max)
+    {
+      return dynamic();
+    }
+    else
+    {
+      if (dimension == N)
+      {
+        return fixed(std::integral_constant<size_t, N>());
+      }
+
+      return dispatchDimensionFrom<N + 1, Max>(dimension, fixed, dynamic);
+    }
+  }
+
+  /*!
+    * \brief Turns a runtime problem size into a compile time one.
+    *
+    * Sizes 1 .. Max call fixed with std::integral_constant<size_t, size>, which can then work on std::array
+    * positions (no allocations, unrolled loops, everything in registers for the small sizes); any other size
+    * calls dynamic. Both must return the same type. fixed may still fall back to dynamic (e.g. when the
+    * objective function only accepts a std::vector).
+    * \tparam Max - the largest size with a compile time code path
+    *
+    * \param dimension - the runtime problem size
+    * \param fixed - the compile time size code path
+    * \param dynamic - the runtime size code path
+    *
+    * \return the result of the path taken
+    * \ingroup utility
+    */
+  template <size_t Max = MAX_FIXED_DIMENSION, class FixedFunction, class DynamicFunction>
+  decltype(auto) dispatchDimension(size_t dimension, FixedFunction&& fixed, DynamicFunction&& dynamic)
+  {
+    return dispatchDimensionFrom<1, Max>(dimension, fixed, dynamic);
+  }
+}
+
+#endif // !__FIXED_DIMENSION_H__
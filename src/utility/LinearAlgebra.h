@@ -0,0 +1,270 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: small dense linear algebra - square matrices and the symmetric eigen decomposition
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __LINEAR_ALGEBRA_H__
+#define __LINEAR_ALGEBRA_H__
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "Defines.h"
+#include "AlignedAllocator.h"
+
+namespace utility
+{
+  /*! \class SquareMatrix "LinearAlgebra.h"
+    * \brief A dense n x n matrix, row major, every row aligned and padded to a cache line.
+    *
+    * The algorithms below only ever walk rows, so their inner loops are contiguous and vectorize.
+    * \tparam Type - float or double
+    * \ingroup utility
+    */
+  template <typename Type>
+  class SquareMatrix
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param size - the number of rows (and columns)
+      * \param diagonal - the value on the diagonal; 1 gives the identity
+      */
+    explicit SquareMatrix(size_t size = 0, Type diagonal = 0) :
+      _size(size)
+    , _stride((size * sizeof(Type) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE / sizeof(Type))
+    , _data(size * _stride, 0)
+    {
+      FOR(i, size)
+      {
+        (*this)(i, i) = diagonal;
+      }
+    }
+
+    //! the number of rows
+    size_t size() const { return _size; }
+
+    //! the distance between two rows
+    size_t stride() const { return _stride; }
+
+    //! a row, stride() values (the padding is kept at 0)
+    Type* row(size_t index) { return _data.data() + index * _stride; }
+
+    //! a row, stride() values (the padding is kept at 0)
+    const Type* row(size_t index) const { return _data.data() + index * _stride; }
+
+    Type& operator()(size_t i, size_t j) { return _data[i * _stride + j]; }
+
+    Type operator()(size_t i, size_t j) const { return _data[i * _stride + j]; }
+
+  protected:
+    size_t _size;
+    size_t _stride;
+    AlignedVector<Type> _data;
+  };
+
+
+  /*!
+    * \brief The eigen decomposition of a symmetric matrix: Householder reduction to tridiagonal form, then implicit QL
+    *
+    * The EISPACK tred2 / tql2 pair, rearranged so that every O(n^3) loop works on whole rows: the trailing matrix
+    * product and the rank two update of a reflection are sums of scaled rows (the matrix is symmetric), and the
+    * eigenvectors are kept one per row, so a QL rotation (or a reflection) combines two (or all the) rows.
+    * \tparam Type - float or double
+    *
+    * \param[in,out] matrix - the symmetric matrix; destroyed
+    * \param[out] eigenvalues - the eigenvalues, size() values, unsorted
+    * \param[out] eigenvectors - the eigenvectors (unit length), one per row, in the order of the eigenvalues
+    *
+    * \return false when the QL iterations did not converge (never seen on a finite matrix)
+    * \ingroup utility
+    */
+  template <typename Type>
+  bool symmetricEigen(SquareMatrix<Type>& matrix, std::span<Type> eigenvalues, SquareMatrix<Type>& eigenvectors)
+  {
+    const auto n = matrix.size();
+    const auto stride = matrix.stride();
+    eigenvectors = SquareMatrix<Type>(n, 1);
+    if (!n)
+    {
+      return true;
+    }
+
+    auto& diagonal = eigenvalues;
+    std::vector<Type> offDiagonal(n, 0), v(n), w(n), u(stride);
+
+    // Householder: reflection k zeroes row (and column) k beyond the first off diagonal element
+    for (size_t k = 0; k + 2 < n; ++k)
+    {
+      const auto first = k + 1;
+      const auto* x = matrix.row(k);
+      auto tail = static_cast<Type>(0);
+      for (auto i = first + 1; i < n; ++i)
+      {
+        tail += x[i] * x[i];
+      }
+      diagonal[k] = x[k];
+      if (tail == 0)
+      {
+        offDiagonal[k] = x[first];
+        continue;
+      }
+
+      // v = x - alpha e1, alpha of the opposite sign of x[first] (no cancellation); H = I - beta v v^T
+      const auto norm = std::sqrt(tail + x[first] * x[first]);
+      const auto alpha = x[first] > 0 ? -norm : norm;
+      std::fill(v.begin(), v.end(), static_cast<Type>(0));
+      for (auto i = first; i < n; ++i)
+      {
+        v[i] = x[i];
+      }
+      v[first] -= alpha;
+      const auto beta = 2 / (tail + v[first] * v[first]);
+      offDiagonal[k] = alpha;
+
+      // p = beta A' v as a sum of rows of the trailing matrix A', then w = p - (beta / 2) (p.v) v
+      std::fill(w.begin(), w.end(), static_cast<Type>(0));
+      for (auto j = first; j < n; ++j)
+      {
+        const auto factor = beta * v[j];
+        const Type* __restrict row = matrix.row(j);
+        Type* __restrict target = w.data();
+        for (auto i = first; i < n; ++i)
+        {
+          target[i] += factor * row[i];
+        }
+      }
+      auto pv = static_cast<Type>(0);
+      for (auto i = first; i < n; ++i)
+      {
+        pv += w[i] * v[i];
+      }
+      const auto half = beta * pv / 2;
+      for (auto i = first; i < n; ++i)
+      {
+        w[i] -= half * v[i];
+      }
+
+      // A' = H A' H = A' - v w^T - w v^T
+      for (auto i = first; i < n; ++i)
+      {
+        const auto vi = v[i], wi = w[i];
+        Type* __restrict row = matrix.row(i);
+        const Type* __restrict vv = v.data();
+        const Type* __restrict ww = w.data();
+        for (auto j = first; j < n; ++j)
+        {
+          row[j] -= vi * ww[j] + wi * vv[j];
+        }
+      }
+
+      // Q^T = H Q^T: every row loses beta v_i (v^T Q^T)
+      std::fill(u.begin(), u.end(), static_cast<Type>(0));
+      for (auto i = first; i < n; ++i)
+      {
+        const auto factor = v[i];
+        const Type* __restrict row = eigenvectors.row(i);
+        Type* __restrict target = u.data();
+        for (size_t j = 0; j < stride; ++j)
+        {
+          target[j] += factor * row[j];
+        }
+      }
+      for (auto i = first; i < n; ++i)
+      {
+        const auto factor = beta * v[i];
+        Type* __restrict row = eigenvectors.row(i);
+        const Type* __restrict source = u.data();
+        for (size_t j = 0; j < stride; ++j)
+        {
+          row[j] -= factor * source[j];
+        }
+      }
+    }
+    if (n > 1)
+    {
+      diagonal[n - 2] = matrix(n - 2, n - 2);
+      offDiagonal[n - 2] = matrix(n - 2, n - 1);
+    }
+    diagonal[n - 1] = matrix(n - 1, n - 1);
+
+    // implicit QL with Wilkinson shifts on the tridiagonal matrix; offDiagonal[i] couples i and i + 1
+    const auto epsilon = std::numeric_limits<Type>::epsilon();
+    auto shift = static_cast<Type>(0), largest = static_cast<Type>(0);
+    for (size_t l = 0; l < n; ++l)
+    {
+      largest = std::max(largest, std::abs(diagonal[l]) + std::abs(offDiagonal[l]));
+      auto m = l;
+      while (m + 1 < n && std::abs(offDiagonal[m]) > epsilon * largest)
+      {
+        ++m;
+      }
+
+      for (size_t iteration = 0; m > l && std::abs(offDiagonal[l]) > epsilon * largest; ++iteration)
+      {
+        if (iteration == 60)
+        {
+          return false;
+        }
+
+        auto g = diagonal[l];
+        auto p = (diagonal[l + 1] - g) / (2 * offDiagonal[l]);
+        auto r = std::hypot(p, static_cast<Type>(1));
+        r = p < 0 ? -r : r;
+        diagonal[l] = offDiagonal[l] / (p + r);
+        diagonal[l + 1] = offDiagonal[l] * (p + r);
+        const auto next = diagonal[l + 1];
+        auto h = g - diagonal[l];
+        for (auto i = l + 2; i < n; ++i)
+        {
+          diagonal[i] -= h;
+        }
+        shift += h;
+
+        p = diagonal[m];
+        auto c = static_cast<Type>(1), c2 = c, c3 = c;
+        auto s = static_cast<Type>(0), s2 = s;
+        const auto coupling = offDiagonal[l + 1];
+        for (auto i = m; i-- > l;)
+        {
+          c3 = c2;
+          c2 = c;
+          s2 = s;
+          g = c * offDiagonal[i];
+          h = c * p;
+          r = std::hypot(p, offDiagonal[i]);
+          offDiagonal[i + 1] = s * r;
+          s = offDiagonal[i] / r;
+          c = p / r;
+          p = c * diagonal[i] - s * g;
+          diagonal[i + 1] = h + s * (c * g + s * diagonal[i]);
+
+          // the plane rotation of the eigenvectors i and i + 1
+          Type* __restrict vectorI = eigenvectors.row(i);
+          Type* __restrict vectorNext = eigenvectors.row(i + 1);
+          for (size_t k = 0; k < stride; ++k)
+          {
+            const auto xi = vectorI[k];
+            const auto xn = vectorNext[k];
+            vectorNext[k] = s * xi + c * xn;
+            vectorI[k] = c * xi - s * xn;
+          }
+        }
+        p = -s * s2 * c3 * coupling * offDiagonal[l] / next;
+        offDiagonal[l] = s * p;
+        diagonal[l] = c * p;
+      }
+
+      diagonal[l] += shift;
+      offDiagonal[l] = 0;
+    }
+
+    return true;
+  }
+}
+
+#endif // !__LINEAR_ALGEBRA_H__
@@ -0,0 +1,95 @@
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__linux__)
+#include <fstream>
+#include <string>
+#endif
+
+#include "Memory.h"
+
+#if defined(_WIN32)
+
+size_t utility::residentMemoryBytes()
+{
+  PROCESS_MEMORY_COUNTERS counters;
+  return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.WorkingSetSize : 0;
+}
+
+size_t utility::peakResidentMemoryBytes()
+{
+  PROCESS_MEMORY_COUNTERS counters;
+  return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? counters.PeakWorkingSetSize : 0;
+}
+
+bool utility::resetPeakResidentMemory()
+{
+  // the peak working set cannot be reset
+  return false;
+}
+
+#elif defined(__linux__)
+
+namespace
+{
+  //! a "<key>   1234 kB" line of /proc/self/status
+  size_t statusBytes(const std::string& wanted)
+  {
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    while (status >> key)
+    {
+      if (key == wanted)
+      {
+        size_t kilobytes = 0;
+        status >> kilobytes;
+        return kilobytes * 1024;
+      }
+      status.ignore(4096, '\n');
+    }
+
+    return 0;
+  }
+}
+
+size_t utility::residentMemoryBytes()
+{
+  return statusBytes("VmRSS:");
+}
+
+size_t utility::peakResidentMemoryBytes()
+{
+  // the high water mark, unlike getrusage's, can be reset
+  return statusBytes("VmHWM:");
+}
+
+bool utility::resetPeakResidentMemory()
+{
+  // see proc(5), /proc/pid/clear_refs: 5 resets the high water mark (Linux 4.0 and later)
+  std::ofstream clear("/proc/self/clear_refs");
+  clear << "5";
+  clear.flush();
+  return static_cast<bool>(clear);
+}
+
+#else
+
+size_t utility::residentMemoryBytes()
+{
+  return 0;
+}
+
+size_t utility::peakResidentMemoryBytes()
+{
+  return 0;
+}
+
+bool utility::resetPeakResidentMemory()
+{
+  return false;
+}
+
+#endif
@@ -0,0 +1,41 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: process memory footprint
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __MEMORY_H__
+#define __MEMORY_H__
+
+#include <cstddef>
+
+namespace utility
+{
+  /*!
+    * \brief The memory currently resident for the process (working set).
+    *
+    * \return the resident bytes, 0 when the platform does not tell
+    * \ingroup utility
+    */
+  size_t residentMemoryBytes();
+
+
+  /*!
+    * \brief The largest resident memory of the process so far.
+    *
+    * \return the peak resident bytes, 0 when the platform does not tell
+    * \ingroup utility
+    */
+  size_t peakResidentMemoryBytes();
+
+
+  /*!
+    * \brief Restarts peakResidentMemoryBytes from the current resident memory.
+    *
+    * \return false when the platform keeps the peak of the whole process life (it is then left alone)
+    * \ingroup utility
+    */
+  bool resetPeakResidentMemory();
+}
+
+#endif // !__MEMORY_H__
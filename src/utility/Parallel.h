@@ -0,0 +1,67 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: minimal helpers to split a loop across the available cores
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __PARALLEL_H__
+#define __PARALLEL_H__
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+/*! \defgroup utility Common utilities shared by the algorithms */
+namespace utility
+{
+  /*!
+    * \brief Retrieves the number of threads the hardware can run concurrently.
+    *
+    * \return the number of hardware threads (at least 1)
+    * \ingroup utility
+    */
+  inline size_t hardwareThreads()
+  {
+    const auto threads = std::thread::hardware_concurrency();
+    return threads ? threads : 1;
+  }
+
+
+  /*!
+    * \brief Splits [0, count) into contiguous ranges and runs each range on its own thread.
+    *
+    * The calling thread executes the first range, so a single range never spawns a thread.
+    * \tparam ChunkFunction - void(size_t chunk, size_t begin, size_t end)
+    *
+    * \param count - the number of items to process
+    * \param chunks - the maximum number of ranges (threads) to use
+    * \param chunkFunction - the function that processes one range
+    *
+    * \return the number of ranges actually used; chunk indices are in [0, return value)
+    * \ingroup utility
+    */
+  template <class ChunkFunction>
+  size_t parallelChunks(size_t count, size_t chunks, ChunkFunction chunkFunction)
+  {
+    chunks = std::max<size_t>(1, std::min(chunks, count));
+
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t chunk = 1; chunk < chunks; ++chunk)
+    {
+      workers.emplace_back(chunkFunction, chunk, count * chunk / chunks, count * (chunk + 1) / chunks);
+    }
+
+    chunkFunction(size_t(0), size_t(0), count / chunks);
+
+    for (auto& worker : workers)
+    {
+      worker.join();
+    }
+
+    return chunks;
+  }
+}
+
+#endif // !__PARALLEL_H__
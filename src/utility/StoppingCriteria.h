@@ -0,0 +1,255 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: when to stop a search - deadline, evaluation budget, target cost, stagnation and cancellation
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __STOPPING_CRITERIA_H__
+#define __STOPPING_CRITERIA_H__
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <stop_token>
+
+namespace utility
+{
+  //! why a search was stopped
+  enum class StopReason
+  {
+    NONE,/*!< still running, or ran all its iterations */
+    DEADLINE,/*!< the wall clock deadline passed */
+    EVALUATIONS,/*!< the evaluation budget is spent */
+    TARGET,/*!< a cost at least as good as the target was found */
+    STAGNATION,/*!< too many evaluations without an improvement */
+    CANCELLED/*!< the cancellation token was triggered */
+  };
+
+
+  /*! \class NeverStop "StoppingCriteria.h"
+    * \brief The default stopping criteria of the algorithms: never stops and compiles away.
+    *
+    * A stopping criteria is anything with the members below; the algorithms call evaluated() after
+    * every objective evaluation (or batch of them) and stop when it returns true, and improved() every
+    * time they accept a better cost. They always return the best solution found so far.
+    * \ingroup utility
+    */
+  struct NeverStop
+  {
+    //! never stops
+    bool evaluated(size_t = 1) const { return false; }
+
+    //! ignored
+    void improved() const { ; }
+
+    //! ignored
+    void improved(double) const { ; }
+
+    //! no target cost, the algorithms do not need to compute the cost for improved()
+    static constexpr bool hasTarget() { return false; }
+
+    //! never stops
+    bool stopped() const { return false; }
+  };
+
+
+  /*! \class StoppingCriteria "StoppingCriteria.h"
+    * \brief Stops a search on a deadline, an evaluation budget, a target cost, stagnation or cancellation.
+    *
+    * Every criterion is optional (an unconfigured object never stops). The hot path, evaluated(), only adds
+    * to a counter and compares it to the next checkpoint; the clock and the cancellation token are read at
+    * most once every checkInterval() evaluations, while the budget and the stagnation limit are exact
+    * (they are checkpoints themselves). The target cost stops the search at the improvement reaching it.
+    *
+    * The object is reusable: start() forgets the previous run and re-arms a relative time limit.
+    * \ingroup utility
+    */
+  class StoppingCriteria
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    //! the default number of evaluations between two reads of the clock
+    static const size_t CHECK_INTERVAL = 64;
+
+    //! an absolute wall clock deadline
+    StoppingCriteria& deadline(Clock::time_point at)
+    {
+      _deadline = at;
+      _timeLimit = Clock::duration::zero();
+      return *this;
+    }
+
+    //! a wall clock deadline relative to now (and to every start())
+    StoppingCriteria& timeLimit(Clock::duration limit)
+    {
+      _timeLimit = limit;
+      _deadline = Clock::now() + limit;
+      return *this;
+    }
+
+    //! the maximum number of objective evaluations
+    StoppingCriteria& evaluationBudget(size_t evaluations)
+    {
+      _budget = evaluations;
+      rearm();
+      return *this;
+    }
+
+    /*!
+      * \brief stop as soon as a cost at least as good as the target is accepted
+      * \param cost - the target
+      * \param minimize - true when smaller costs are better
+      */
+    StoppingCriteria& targetCost(double cost, bool minimize = true)
+    {
+      _target = cost;
+      _hasTarget = true;
+      _minimize = minimize;
+      return *this;
+    }
+
+    //! the maximum number of evaluations since the last improvement
+    StoppingCriteria& stagnationLimit(size_t evaluations)
+    {
+      _stagnation = evaluations;
+      rearm();
+      return *this;
+    }
+
+    //! stops when a stop is requested on the source of the token
+    StoppingCriteria& cancellation(std::stop_token token)
+    {
+      _token = std::move(token);
+      return *this;
+    }
+
+    //! the number of evaluations between two reads of the clock (and of the cancellation token)
+    StoppingCriteria& checkInterval(size_t evaluations)
+    {
+      _interval = std::max<size_t>(evaluations, 1);
+      rearm();
+      return *this;
+    }
+
+    //! forgets the previous run; a time limit restarts from now
+    void start()
+    {
+      if (_timeLimit != Clock::duration::zero())
+      {
+        _deadline = Clock::now() + _timeLimit;
+      }
+      _evaluations = 0;
+      _lastImprovement = 0;
+      _reason = StopReason::NONE;
+      rearm();
+    }
+
+    /*!
+      * \brief Counts objective evaluations
+      * \param count - the number of evaluations since the last call
+      * \return true when the search must stop
+      */
+    bool evaluated(size_t count = 1)
+    {
+      _evaluations += count;
+      if (_evaluations < _nextCheck)
+      {
+        return false;
+      }
+
+      return check();
+    }
+
+    //! a better solution was accepted, its cost is unknown (only resets the stagnation)
+    void improved()
+    {
+      _lastImprovement = _evaluations;
+    }
+
+    //! a better solution was accepted
+    void improved(double cost)
+    {
+      _lastImprovement = _evaluations;
+      if (_hasTarget && _reason == StopReason::NONE && (_minimize ? cost <= _target : cost >= _target))
+      {
+        _reason = StopReason::TARGET;
+        _nextCheck = 0;
+      }
+    }
+
+    //! true when improved() needs the cost
+    bool hasTarget() const { return _hasTarget; }
+
+    //! true once a criterion was met
+    bool stopped() const { return _reason != StopReason::NONE; }
+
+    //! the criterion met, if any
+    StopReason reason() const { return _reason; }
+
+    //! the number of evaluations counted since start()
+    size_t evaluations() const { return _evaluations; }
+
+    //! the cancellation token (the default one never stops)
+    const std::stop_token& cancellationToken() const { return _token; }
+
+  protected:
+    //! the slow path of evaluated()
+    bool check()
+    {
+      if (_reason == StopReason::NONE)
+      {
+        if (_evaluations >= _budget)
+        {
+          _reason = StopReason::EVALUATIONS;
+        }
+        else if (_evaluations - _lastImprovement >= _stagnation)
+        {
+          _reason = StopReason::STAGNATION;
+        }
+        else if (_token.stop_requested())
+        {
+          _reason = StopReason::CANCELLED;
+        }
+        else if (_deadline != Clock::time_point::max() && Clock::now() >= _deadline)
+        {
+          _reason = StopReason::DEADLINE;
+        }
+      }
+
+      rearm();
+      return stopped();
+    }
+
+    //! the next checkpoint: the next clock read, the budget or the stagnation limit, whichever comes first
+    void rearm()
+    {
+      if (stopped())
+      {
+        _nextCheck = 0;
+        return;
+      }
+
+      const auto stagnation = _stagnation - std::min(_stagnation, _evaluations - _lastImprovement);
+      _nextCheck = _evaluations + std::min({ _interval, _budget - std::min(_budget, _evaluations), stagnation });
+    }
+
+    Clock::time_point _deadline = Clock::time_point::max();/*!< max when there is no deadline */
+    Clock::duration _timeLimit = Clock::duration::zero();/*!< the relative deadline re-armed by start() */
+    size_t _budget = std::numeric_limits<size_t>::max();/*!< the evaluation budget */
+    size_t _stagnation = std::numeric_limits<size_t>::max();/*!< the stagnation limit */
+    double _target = 0;/*!< the target cost */
+    bool _hasTarget = false;
+    bool _minimize = true;/*!< the direction of the target */
+    std::stop_token _token;/*!< the cancellation token; the default one never stops */
+    size_t _interval = CHECK_INTERVAL;/*!< evaluations between two reads of the clock */
+
+    size_t _evaluations = 0;/*!< the evaluations counted */
+    size_t _lastImprovement = 0;/*!< the evaluation count at the last improvement */
+    size_t _nextCheck = CHECK_INTERVAL;/*!< the evaluation count at which check() runs */
+    StopReason _reason = StopReason::NONE;
+  };
+}
+
+#endif // !__STOPPING_CRITERIA_H__
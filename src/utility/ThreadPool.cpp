@@ -0,0 +1,187 @@
+#include "Affinity.h"
+#include "ThreadPool.h"
+
+namespace
+{
+  //! the pool the calling thread works for, and its slot (see ThreadPool::slot)
+  thread_local const utility::ThreadPool* t_pool = nullptr;
+  thread_local size_t t_slot = 0;
+}
+
+utility::ThreadPool::ThreadPool(const ThreadPoolOptions& options)
+{
+  const auto workers = options.workers ? options.workers : hardwareThreads() - 1;
+  const auto processors = options.pin ? physicalCoreProcessors() : std::vector<size_t>();
+
+  _queues.reserve(workers);
+  FOR(w, workers)
+  {
+    _queues.push_back(std::make_unique<Queue>());
+  }
+
+  _threads.reserve(workers);
+  FOR(w, workers)
+  {
+    _threads.emplace_back([this, w, processors]()
+      {
+        // pinning is best effort: an unpinned worker works just as well
+        if (!processors.empty())
+        {
+          pinCurrentThread(processors[w % processors.size()]);
+        }
+        work(w);
+      });
+  }
+}
+
+utility::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(_sleepMutex);
+    _stop = true;
+  }
+  _wake.notify_all();
+
+  for (auto& thread : _threads)
+  {
+    thread.join();
+  }
+}
+
+utility::ThreadPool& utility::ThreadPool::shared()
+{
+  static ThreadPool s_pool;
+  return s_pool;
+}
+
+size_t utility::ThreadPool::slot() const
+{
+  return t_pool == this ? t_slot : 0;
+}
+
+void utility::ThreadPool::submit(Task task)
+{
+  if (_queues.empty())
+  {
+    task();
+    return;
+  }
+
+  const auto own = slot();
+  auto& queue = *_queues[own ? own - 1 : _nextQueue.fetch_add(1, std::memory_order_relaxed) % _queues.size()];
+
+  // counted before it is visible, so a worker finding it never sees the count at 0
+  _queued.fetch_add(1, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+
+  // an empty critical section orders the count with a worker checking it before it sleeps
+  {
+    std::lock_guard<std::mutex> lock(_sleepMutex);
+  }
+  _wake.notify_one();
+}
+
+bool utility::ThreadPool::runPending()
+{
+  if (_queues.empty())
+  {
+    return false;
+  }
+
+  const auto own = slot();
+  Task task;
+  if (!take(own ? own - 1 : _nextQueue.load(std::memory_order_relaxed) % _queues.size(), task))
+  {
+    return false;
+  }
+
+  task();
+  return true;
+}
+
+bool utility::ThreadPool::take(size_t own, Task& task)
+{
+  // the own deque from the back: the most recent task, its data is still in cache
+  if (slot() == own + 1)
+  {
+    auto& queue = *_queues[own];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+      _queued.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  // steal from the front of the others: the oldest task
+  const auto queues = _queues.size();
+  for (size_t offset = slot() == own + 1 ? 1 : 0; offset < queues; ++offset)
+  {
+    auto& queue = *_queues[(own + offset) % queues];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.tasks.empty())
+    {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+      _queued.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void utility::ThreadPool::work(size_t index)
+{
+  t_pool = this;
+  t_slot = index + 1;
+
+  Task task;
+  for (;;)
+  {
+    if (take(index, task))
+    {
+      task();
+      task = nullptr;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(_sleepMutex);
+    _wake.wait(lock, [this]() { return _stop || _queued.load(std::memory_order_acquire) > 0; });
+    if (_stop && !_queued.load(std::memory_order_acquire))
+    {
+      return;
+    }
+  }
+}
+
+void utility::TaskGroup::wait()
+{
+  // a worker keeps working while it waits: the tasks it waits for may be queued behind it
+  if (_pool.slot())
+  {
+    for (;;)
+    {
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_pending)
+        {
+          return;
+        }
+      }
+
+      if (!_pool.runPending())
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _done.wait(lock, [this]() { return !_pending; });
+}
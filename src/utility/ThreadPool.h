@@ -0,0 +1,304 @@
+// implementation: Alin Stroe
+// mail to: afstroe@gmail.com
+// linkedin: https://www.linkedin.com/in/alinstroe/
+// purpose: a work stealing thread pool shared by the parallel algorithms - parallel loops, task groups, per worker scratch
+// Copyright © 2020 Alin Stroe, all rights reserved
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Defines.h"
+#include "AlignedAllocator.h"
+#include "Parallel.h"
+
+namespace utility
+{
+  /*! \class ThreadPoolOptions "ThreadPool.h"
+    * \brief How a thread pool is set up.
+    * \ingroup utility
+    */
+  struct ThreadPoolOptions
+  {
+    size_t workers = 0;/*!< the number of worker threads; 0: one less than the hardware threads (the caller works too) */
+    bool pin = false;/*!< pin worker i to the i-th physical core (see physicalCoreProcessors) */
+  };
+
+
+  /*! \class ThreadPool "ThreadPool.h"
+    * \brief A work stealing thread pool.
+    *
+    * Every worker owns a deque of tasks: it pops its own tasks from the back (the most recent, still in
+    * cache) and, when it runs out, steals from the front of the others' deques (the oldest, usually the
+    * largest pieces of work). Idle workers sleep until a task is submitted.
+    *
+    * The algorithms share one pool (see shared()), so running several of them in one process (a portfolio,
+    * the benchmark workers) does not oversubscribe the cores the way a set of threads per call does.
+    * Tasks should be short and must not block on one another; long running work (e.g. the solvers of a
+    * stochastic::Portfolio) belongs on its own threads.
+    * \ingroup utility
+    */
+  class ThreadPool
+  {
+  public:
+    using Task = std::function<void()>;
+
+    /*!
+      * \brief init c-tor - starts the workers
+      * \param options - the number of workers and their pinning
+      */
+    explicit ThreadPool(const ThreadPoolOptions& options = ThreadPoolOptions());
+
+    //! runs the tasks left, then joins the workers
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //! the process wide pool, hardwareThreads() - 1 unpinned workers, created on first use
+    static ThreadPool& shared();
+
+    //! the number of worker threads
+    size_t workers() const { return _queues.size(); }
+
+    //! the number of threads working on a parallel loop: the workers and the caller
+    size_t concurrency() const { return workers() + 1; }
+
+    //! the scratch slot of the calling thread: 1 .. workers() for the workers, 0 for any other thread (see WorkerLocal)
+    size_t slot() const;
+
+    //! queues a task; a worker queues it on its own deque, any other thread spreads its tasks over the workers
+    void submit(Task task);
+
+    /*!
+      * \brief Runs one queued task on the calling thread, if there is one
+      * \return false when no task was found
+      */
+    bool runPending();
+
+    /*!
+      * \brief Runs a loop over [0, count) split in chunks of grain items.
+      *
+      * The calling thread works on the loop too, and at most threads - 1 workers join it: they claim the
+      * chunks one at a time, so faster threads simply take more chunks. The calling thread only runs chunks of
+      * this loop (never other tasks), so per thread scratch (see WorkerLocal) is never shared. The chunk
+      * boundaries only depend on count and grain: a reduction combining its chunks in order gives the same
+      * result on any number of threads.
+      * \tparam ChunkFunction - void(size_t chunk, size_t begin, size_t end)
+      *
+      * \param count - the number of items
+      * \param grain - the number of items of a chunk (the last one may be smaller)
+      * \param chunkFunction - processes one chunk; called concurrently
+      * \param threads - the maximum number of threads, caller included; 0 for concurrency()
+      *
+      * \return the number of chunks: (count + grain - 1) / grain
+      */
+    template <class ChunkFunction>
+    size_t parallelFor(size_t count, size_t grain, ChunkFunction chunkFunction, size_t threads = 0)
+    {
+      grain = std::max<size_t>(grain, 1);
+      const auto chunks = (count + grain - 1) / grain;
+      const auto limit = threads ? threads : concurrency();
+      const auto helpers = std::min({ workers(), chunks ? chunks - 1 : 0, limit ? limit - 1 : 0 });
+
+      const auto runChunk = [&](size_t chunk)
+      {
+        const auto begin = chunk * grain;
+        chunkFunction(chunk, begin, std::min(begin + grain, count));
+      };
+
+      if (!helpers)
+      {
+        FOR(chunk, chunks)
+        {
+          runChunk(chunk);
+        }
+
+        return chunks;
+      }
+
+      // a helper starting after the loop is done claims nothing, so it never touches runChunk;
+      // the claims and the completions live as long as the last helper
+      struct Loop
+      {
+        std::atomic<size_t> next{ 0 };
+        std::atomic<size_t> done{ 0 };
+      };
+      const auto loop = std::make_shared<Loop>();
+      const auto drain = [chunks, runChunk = &runChunk](Loop& state)
+      {
+        for (auto chunk = state.next.fetch_add(1, std::memory_order_relaxed); chunk < chunks; chunk = state.next.fetch_add(1, std::memory_order_relaxed))
+        {
+          (*runChunk)(chunk);
+          if (state.done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks)
+          {
+            state.done.notify_all();
+          }
+        }
+      };
+
+      FOR(helper, helpers)
+      {
+        submit([loop, drain]() { drain(*loop); });
+      }
+      drain(*loop);
+
+      for (auto done = loop->done.load(std::memory_order_acquire); done < chunks; done = loop->done.load(std::memory_order_acquire))
+      {
+        loop->done.wait(done, std::memory_order_acquire);
+      }
+
+      return chunks;
+    }
+
+  protected:
+    //! a worker's deque; cache line aligned so that two workers never share a lock's line
+    struct alignas(CACHE_LINE_SIZE) Queue
+    {
+      std::mutex mutex;
+      std::deque<Task> tasks;
+    };
+
+    //! the loop of worker index
+    void work(size_t index);
+
+    //! takes a task: the back of queue own (if any), then the front of the others, starting after own
+    bool take(size_t own, Task& task);
+
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _threads;
+    std::atomic<size_t> _queued{ 0 };/*!< the tasks submitted and not taken yet */
+    std::atomic<size_t> _nextQueue{ 0 };/*!< round robin over the queues for the tasks of other threads */
+    std::mutex _sleepMutex;
+    std::condition_variable _wake;
+    bool _stop = false;/*!< guarded by _sleepMutex */
+  };
+
+
+  /*! \class TaskGroup "ThreadPool.h"
+    * \brief A set of tasks that can be waited for together.
+    *
+    * Waiting on a worker thread runs queued tasks meanwhile (so nested groups do not deadlock); any other
+    * thread sleeps. Without workers the tasks run right away, on the calling thread.
+    * \ingroup utility
+    */
+  class TaskGroup
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param pool - the pool running the tasks
+      */
+    explicit TaskGroup(ThreadPool& pool = ThreadPool::shared()) :
+      _pool(pool)
+    {
+      ;
+    }
+
+    //! waits for the tasks
+    ~TaskGroup()
+    {
+      wait();
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    /*!
+      * \brief Runs a task on the pool
+      * \tparam Function - void()
+      * \param function - the task
+      */
+    template <class Function>
+    void run(Function function)
+    {
+      if (!_pool.workers())
+      {
+        function();
+        return;
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_pending;
+      }
+      _pool.submit([this, function = std::move(function)]() mutable
+        {
+          function();
+
+          // notified under the lock: wait() cannot return (and destroy the group) before this is done
+          std::lock_guard<std::mutex> lock(_mutex);
+          if (!--_pending)
+          {
+            _done.notify_all();
+          }
+        });
+    }
+
+    //! waits until every task run so far is done
+    void wait();
+
+  protected:
+    ThreadPool& _pool;
+    std::mutex _mutex;
+    std::condition_variable _done;
+    size_t _pending = 0;/*!< guarded by _mutex */
+  };
+
+
+  /*! \class WorkerLocal "ThreadPool.h"
+    * \brief Scratch owned by each thread of a pool: one value per worker, and one for the calling thread.
+    *
+    * Lets the chunks of a parallel loop reuse their buffers (or a copy of a function object) instead of
+    * creating them per chunk. Every value is on its own cache lines. The non worker slot is shared by all
+    * the other threads, so a WorkerLocal belongs to one parallel region (its caller and the pool).
+    * \tparam Type - the scratch type
+    * \ingroup utility
+    */
+  template <class Type>
+  class WorkerLocal
+  {
+  public:
+    /*!
+      * \brief init c-tor
+      * \param pool - the pool whose threads use the scratch
+      * \param initial - the initial value of every slot
+      */
+    explicit WorkerLocal(ThreadPool& pool = ThreadPool::shared(), const Type& initial = Type()) :
+      _pool(pool)
+    , _slots(pool.concurrency(), Slot{ initial })
+    {
+      ;
+    }
+
+    //! the calling thread's value
+    Type& local() { return _slots[_pool.slot()].value; }
+
+    //! the number of values
+    size_t size() const { return _slots.size(); }
+
+    //! a value, e.g. to combine them after the loop
+    Type& operator[](size_t slot) { return _slots[slot].value; }
+
+  protected:
+    struct alignas(CACHE_LINE_SIZE) Slot
+    {
+      Type value;
+    };
+
+    ThreadPool& _pool;
+    std::vector<Slot> _slots;
+  };
+}
+
+#endif // !__THREAD_POOL_H__